@@ -24,6 +24,7 @@ namespace ndn {
 
 ActionEntry::ActionEntry(const Name& creatorName, const Name& dataName, const Action& action)
   : m_creator(creatorName)
+  , m_creatorId(CreatorTable::getInstance().intern(creatorName))
   , m_dataName(dataName)
   , m_action(action)
   , m_seqNo(0)
@@ -33,6 +34,7 @@ ActionEntry::ActionEntry(const Name& creatorName, const Name& dataName, const Ac
 
 ActionEntry::ActionEntry(const Name& creatorName, const uint64_t seqNo)
   : m_creator(creatorName)
+  , m_creatorId(CreatorTable::getInstance().intern(creatorName))
   , m_seqNo(seqNo)
 {
   constructName();
@@ -41,6 +43,7 @@ ActionEntry::ActionEntry(const Name& creatorName, const uint64_t seqNo)
 ActionEntry::ActionEntry(const Name& creatorName, const uint64_t seqNo, const Action& action,
                          const Name& dataName, const uint64_t version)
   : m_creator(creatorName)
+  , m_creatorId(CreatorTable::getInstance().intern(creatorName))
   , m_dataName(dataName)
   , m_action(action)
   , m_seqNo(seqNo)
@@ -49,13 +52,12 @@ ActionEntry::ActionEntry(const Name& creatorName, const uint64_t seqNo, const Ac
   constructName();
 }
 
-DigestPtr
+DigestValue
 ActionEntry::getDigest() const
 {
-  DigestPtr digest = make_shared<Digest> ();
-  *digest << m_name.toUri() << m_seqNo;
-  digest->finalize ();
-  return digest;
+  DigestBuilder builder;
+  builder << m_name.toUri() << m_seqNo;
+  return builder.finalize();
 }
 
 void
@@ -22,6 +22,7 @@
 
 #include "common.hpp"
 #include "sync-digest.hpp"
+#include "creator-table.hpp"
 #include "action-entry.hpp"
 namespace ns3 {
 namespace ndn {
@@ -71,7 +72,7 @@ public:
   ActionEntry(const Name& creatorName, const uint64_t seqNo, const Action& action,
               const Name& dataName, const uint64_t version);
 
-  DigestPtr
+  DigestValue
   getDigest() const;
 
   Name
@@ -92,6 +93,12 @@ public:
     return m_creator;
   }
 
+  CreatorId
+  getCreatorId() const
+  {
+    return m_creatorId;
+  }
+
   Action
   getAction() const
   {
@@ -149,6 +156,7 @@ public:
 private:
   Name m_name;
   Name m_creator;
+  CreatorId m_creatorId;
   Name m_dataName;
   Action m_action;
   uint64_t m_seqNo;    // seqNo will be settled by action detector
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "action-log.hpp"
+
+#include <cmath>
+
+namespace ns3 {
+namespace ndn {
+
+const size_t ActionLog::DEFAULT_SEGMENT_SIZE;
+
+ActionLog::ActionLog(size_t segmentSize)
+  : m_segmentSize(segmentSize)
+  , m_budget(0)
+  , m_begin(0)
+  , m_end(0)
+  , m_evicted(0)
+{
+  if (m_segmentSize == 0)
+    throw Error("Segment size of the action log should be positive");
+}
+
+void
+ActionLog::setBudget(size_t maxEntries)
+{
+  m_budget = maxEntries;
+  while (m_budget != 0 && size() > m_budget && m_segments.size() > 1)
+    evict();
+}
+
+void
+ActionLog::clear()
+{
+  m_segments.clear();
+  m_index.clear();
+  m_actions.clear();
+  m_begin = m_end;
+}
+
+uint64_t
+ActionLog::append(const DigestValue& digest, const ActionEntry& action)
+{
+  if (m_segments.empty() || m_segments.back().size() == m_segmentSize) {
+    m_segments.push_back(Segment());
+    m_segments.back().swap(m_spare);
+    m_segments.back().reserve(m_segmentSize);
+  }
+  m_segments.back().push_back(std::make_pair(digest, action));
+  uint64_t position = m_end++;
+  m_index.insert(std::make_pair(digest, position));
+  m_actions[ActionKey(action.getCreatorId(), action.getSeqNo())] = position;
+
+  while (m_budget != 0 && size() > m_budget && m_segments.size() > 1)
+    evict();
+  return position;
+}
+
+void
+ActionLog::reserve(size_t count)
+{
+  // every entry adds an action key, while a batch adds a single new digest
+  size_t buckets = static_cast<size_t>(std::ceil((m_actions.size() + count) / m_actions.max_load_factor()));
+  if (buckets > m_actions.bucket_count())
+    m_actions.rehash(buckets);
+}
+
+void
+ActionLog::setLastDigest(const DigestValue& digest)
+{
+  if (empty())
+    throw Error("Cannot set the digest of an empty action log");
+
+  uint64_t position = m_end - 1;
+  Entry& last = m_segments.back().back();
+  boost::unordered_map<DigestValue, uint64_t, DigestValueHash>::iterator it = m_index.find(last.first);
+  if (it != m_index.end() && it->second == position)
+    m_index.erase(it);
+  last.first = digest;
+  m_index.insert(std::make_pair(digest, position));
+}
+
+ActionLog::const_iterator
+ActionLog::find(const DigestValue& digest) const
+{
+  boost::unordered_map<DigestValue, uint64_t, DigestValueHash>::const_iterator it = m_index.find(digest);
+  if (it == m_index.end())
+    return end();
+  return const_iterator(this, it->second);
+}
+
+ActionLog::const_iterator
+ActionLog::find(CreatorId creator, uint64_t seq) const
+{
+  boost::unordered_map<ActionKey, uint64_t>::const_iterator it = m_actions.find(ActionKey(creator, seq));
+  if (it == m_actions.end())
+    return end();
+  return const_iterator(this, it->second);
+}
+
+const ActionLog::Entry&
+ActionLog::at(uint64_t position) const
+{
+  if (position < m_begin || position >= m_end)
+    throw Error("Position is out of the action log");
+
+  uint64_t offset = position - m_begin;
+  return m_segments[offset / m_segmentSize][offset % m_segmentSize];
+}
+
+void
+ActionLog::evict()
+{
+  Segment& segment = m_segments.front();
+  // the repos at the digest of the last evicted entry only miss entries that are still in the
+  // log when the next one has been logged under the same digest, by a batch
+  const DigestValue& next = m_segments[1].front().first;
+  uint64_t last = m_begin + segment.size() - 1;
+  EvictedSeqs seqs;
+  uint64_t position = m_begin;
+  for (Segment::const_iterator it = segment.begin(); it != segment.end(); ++it, ++position) {
+    // a digest found before this entry misses it as well
+    boost::unordered_map<DigestValue, uint64_t, DigestValueHash>::iterator entry = m_index.find(it->first);
+    if (entry != m_index.end() && entry->second <= position &&
+        !(entry->second == last && it->first == next))
+      m_index.erase(entry);
+
+    uint64_t& seq = seqs[it->second.getCreatorId()];
+    if (seq < it->second.getSeqNo())
+      seq = it->second.getSeqNo();
+
+    boost::unordered_map<ActionKey, uint64_t>::iterator action =
+      m_actions.find(ActionKey(it->second.getCreatorId(), it->second.getSeqNo()));
+    if (action != m_actions.end() && action->second == position)
+      m_actions.erase(action);
+  }
+
+  size_t count = segment.size();
+  m_begin += count;
+  m_evicted += count;
+  segment.clear();
+  m_spare.swap(segment);
+  m_segments.pop_front();
+
+  if (!m_onEviction.empty())
+    m_onEviction(count, seqs);
+}
+
+} // namespace ndn
+} // namespace ns3
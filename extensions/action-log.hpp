@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_ACTION_LOG_HPP
+#define REPO_SYNC_ACTION_LOG_HPP
+
+#include "common.hpp"
+#include "sync-digest.hpp"
+#include "action-entry.hpp"
+
+#include <deque>
+#include <boost/unordered_map.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Log of the actions a repo has applied, each recorded with the root digest after it
+ *
+ * Entries are stored in fixed size segments that are recycled as a ring: the log grows at
+ * the back and, once it holds more entries than the budget, drops whole segments from the
+ * front.  Every entry has an absolute position that never changes while the entry is in
+ * the log.  Root digests and actions are indexed by position, so the entries following a
+ * digest are handed out as a span and an action is found without searching the log.
+ */
+class ActionLog : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  typedef std::pair<DigestValue, ActionEntry> Entry;
+
+  /**
+   * @brief highest evicted sequence number of each creator
+   */
+  typedef boost::unordered_map<CreatorId, uint64_t> EvictedSeqs;
+
+  /**
+   * @brief called after a segment has been evicted, with the number of evicted entries and
+   *        the highest sequence number evicted for each creator
+   */
+  typedef boost::function<void (size_t, const EvictedSeqs&)> EvictionCallback;
+
+  class const_iterator
+    : public boost::iterator_facade<const_iterator, const Entry,
+                                    boost::random_access_traversal_tag>
+  {
+  public:
+    const_iterator()
+      : m_log(0)
+      , m_position(0)
+    {
+    }
+
+    const_iterator(const ActionLog* log, uint64_t position)
+      : m_log(log)
+      , m_position(position)
+    {
+    }
+
+    uint64_t
+    getPosition() const
+    {
+      return m_position;
+    }
+
+  private:
+    friend class boost::iterator_core_access;
+
+    const Entry&
+    dereference() const
+    {
+      return m_log->at(m_position);
+    }
+
+    bool
+    equal(const const_iterator& other) const
+    {
+      return m_position == other.m_position;
+    }
+
+    void
+    increment()
+    {
+      ++m_position;
+    }
+
+    void
+    decrement()
+    {
+      --m_position;
+    }
+
+    void
+    advance(std::ptrdiff_t n)
+    {
+      m_position += n;
+    }
+
+    std::ptrdiff_t
+    distance_to(const const_iterator& other) const
+    {
+      return static_cast<std::ptrdiff_t>(other.m_position - m_position);
+    }
+
+  private:
+    const ActionLog* m_log;
+    uint64_t m_position;
+  };
+
+  typedef boost::iterator_range<const_iterator> Range;
+
+  static const size_t DEFAULT_SEGMENT_SIZE = 256;
+
+  /**
+   * @param segmentSize  number of entries per segment, which is also the eviction granularity
+   */
+  explicit
+  ActionLog(size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+  /**
+   * @brief set the maximum number of entries kept in the log, 0 means unbounded
+   *
+   * The log may exceed the budget by less than one segment, since only full segments
+   * are evicted and the newest segment is never evicted.
+   */
+  void
+  setBudget(size_t maxEntries);
+
+  size_t
+  getBudget() const
+  {
+    return m_budget;
+  }
+
+  void
+  onEviction(const EvictionCallback& callback)
+  {
+    m_onEviction = callback;
+  }
+
+  /**
+   * @brief drop every entry, positions keep increasing across a clear
+   */
+  void
+  clear();
+
+  /**
+   * @brief append an action applied with the resulting root digest
+   *
+   * A digest that is already in the log keeps pointing at its first position.
+   *
+   * @return the position of the new entry
+   */
+  uint64_t
+  append(const DigestValue& digest, const ActionEntry& action);
+
+  /**
+   * @brief make room for 'count' more entries, so that appending a batch does not rehash
+   */
+  void
+  reserve(size_t count);
+
+  /**
+   * @brief change the digest of the last entry, e.g. after a snapshot has been applied
+   */
+  void
+  setLastDigest(const DigestValue& digest);
+
+  /**
+   * @brief find the first entry that was logged with the digest
+   *
+   * An evicted entry is still found while the entries logged after it under the same digest,
+   * by a batch, are in the log.  The iterator is then just before the front of the log and
+   * is only meant for entriesAfter().
+   */
+  const_iterator
+  find(const DigestValue& digest) const;
+
+  /**
+   * @brief find the entry of the action with the creator and sequence number
+   */
+  const_iterator
+  find(CreatorId creator, uint64_t seq) const;
+
+  /**
+   * @brief all the entries logged after the one at the iterator
+   */
+  Range
+  entriesAfter(const_iterator it) const
+  {
+    return Range(++it, end());
+  }
+
+  const Entry&
+  at(uint64_t position) const;
+
+  const Entry&
+  front() const
+  {
+    return at(m_begin);
+  }
+
+  const Entry&
+  back() const
+  {
+    return at(m_end - 1);
+  }
+
+  const_iterator
+  begin() const
+  {
+    return const_iterator(this, m_begin);
+  }
+
+  const_iterator
+  end() const
+  {
+    return const_iterator(this, m_end);
+  }
+
+  size_t
+  size() const
+  {
+    return static_cast<size_t>(m_end - m_begin);
+  }
+
+  bool
+  empty() const
+  {
+    return m_begin == m_end;
+  }
+
+  /**
+   * @brief number of entries evicted since the log was created
+   */
+  uint64_t
+  getEvictedCount() const
+  {
+    return m_evicted;
+  }
+
+private:
+  void
+  evict();
+
+private:
+  typedef std::vector<Entry> Segment;
+
+  size_t m_segmentSize;
+  size_t m_budget;
+  std::deque<Segment> m_segments;  // the first segment starts at m_begin, all but the last are full
+  Segment m_spare;                 // storage of the last evicted segment, reused for the next one
+  uint64_t m_begin;                // position of the first entry
+  uint64_t m_end;                  // position after the last entry
+  uint64_t m_evicted;
+  boost::unordered_map<DigestValue, uint64_t, DigestValueHash> m_index;
+  boost::unordered_map<ActionKey, uint64_t> m_actions;
+  EvictionCallback m_onEviction;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_ACTION_LOG_HPP
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "creator-table.hpp"
+
+#include <boost/functional/hash.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+size_t
+NameHash::operator()(const Name& name) const
+{
+  size_t seed = 0;
+  for (Name::const_iterator component = name.begin(); component != name.end(); ++component)
+    boost::hash_combine(seed, boost::hash_range(component->begin(), component->end()));
+  return seed;
+}
+
+CreatorTable&
+CreatorTable::getInstance()
+{
+  static CreatorTable table;
+  return table;
+}
+
+CreatorId
+CreatorTable::intern(const Name& creator)
+{
+  size_t hash = NameHash()(creator);
+  typedef boost::unordered_multimap<size_t, CreatorId>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> range = m_ids.equal_range(hash);
+  for (Iterator it = range.first; it != range.second; ++it) {
+    if (m_names[it->second] == creator)
+      return it->second;
+  }
+
+  CreatorId id = static_cast<CreatorId>(m_names.size());
+  m_ids.insert(std::make_pair(hash, id));
+  m_names.push_back(creator);
+  return id;
+}
+
+CreatorId
+CreatorTable::intern(const std::string& uri)
+{
+  boost::unordered_map<std::string, CreatorId>::iterator it = m_uris.find(uri);
+  if (it != m_uris.end())
+    return it->second;
+
+  CreatorId id = intern(Name(uri));
+  m_uris.insert(std::make_pair(uri, id));
+  return id;
+}
+
+const Name&
+CreatorTable::getName(CreatorId id) const
+{
+  if (id >= m_names.size())
+    throw Error("No creator with such id");
+  return m_names[id];
+}
+
+} // namespace ndn
+} // namespace ns3
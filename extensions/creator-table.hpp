@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_CREATOR_TABLE_HPP
+#define REPO_SYNC_CREATOR_TABLE_HPP
+
+#include "common.hpp"
+
+#include <boost/unordered_map.hpp>
+#include <deque>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief dense integer id of a creator name
+ */
+typedef uint32_t CreatorId;
+
+/**
+ * @brief key of the per action tables, (creator id, sequence number)
+ */
+typedef std::pair<CreatorId, uint64_t> ActionKey;
+
+/**
+ * @brief hash of a name, combining the hashes of the bytes of its components
+ */
+struct NameHash
+{
+  size_t
+  operator()(const Name& name) const;
+};
+
+/**
+ * @brief Intern table mapping creator names to dense ids
+ *
+ * Creator names are hashed and copied once, when they are interned; the per creator
+ * and per action tables of the repos are then indexed by id.  Names are only compared
+ * when their hashes match.  Ids are handed out in order starting from 0 and are never
+ * reused.
+ */
+class CreatorTable : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @brief the table shared by all the repos in the simulation
+   */
+  static CreatorTable&
+  getInstance();
+
+  /**
+   * @brief  get the id of the creator, a new id is assigned to an unknown creator
+   */
+  CreatorId
+  intern(const Name& creator);
+
+  /**
+   * @brief  get the id of the creator given by the URI of its name, the name is only
+   *         parsed the first time the URI is seen
+   */
+  CreatorId
+  intern(const std::string& uri);
+
+  const Name&
+  getName(CreatorId id) const;
+
+  size_t
+  size() const
+  {
+    return m_names.size();
+  }
+
+private:
+  boost::unordered_multimap<size_t, CreatorId> m_ids;  // ids by name hash
+  boost::unordered_map<std::string, CreatorId> m_uris;
+  std::deque<Name> m_names;  // indexed by id, deque keeps references valid while growing
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_CREATOR_TABLE_HPP
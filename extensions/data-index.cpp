@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "data-index.hpp"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+
+const size_t DataIndex::INITIAL_SLOTS;
+
+static bool
+compareNames(const DataIndex::Entry* a, const DataIndex::Entry* b)
+{
+  return a->first < b->first;
+}
+
+DataIndex::DataIndex()
+  : m_epoch(0)
+  , m_isModified(false)
+{
+  clearSlots(INITIAL_SLOTS);
+}
+
+DataIndex::const_iterator
+DataIndex::find(const Name& name) const
+{
+  const Slot& slot = m_slots[findSlot(name, hash(name))];
+  if (slot.entry == 0)
+    return end();
+  return begin() + (slot.entry - 1);
+}
+
+std::pair<DataIndex::const_iterator, bool>
+DataIndex::insert(const Name& name, status value)
+{
+  size_t nameHash = hash(name);
+  size_t slot = findSlot(name, nameHash);
+  if (m_slots[slot].entry != 0)
+    return std::make_pair(begin() + (m_slots[slot].entry - 1), false);
+
+  record(name, NONE);
+  m_entries.push_back(std::make_pair(name, value));
+  if (m_entries.size() * 2 > m_slots.size()) {
+    std::vector<Slot> slots = clearSlots(m_slots.size() * 2);
+    for (std::vector<Slot>::const_iterator it = slots.begin(); it != slots.end(); ++it) {
+      if (it->entry != 0)
+        place(it->hash, it->entry);
+    }
+    place(nameHash, m_entries.size());
+  }
+  else {
+    m_slots[slot].hash = nameHash;
+    m_slots[slot].entry = m_entries.size();
+  }
+  return std::make_pair(end() - 1, true);
+}
+
+void
+DataIndex::setStatus(const_iterator it, status value)
+{
+  Entry& entry = m_entries[it - begin()];
+  if (entry.second != value) {
+    record(entry.first, entry.second);
+    entry.second = value;
+  }
+}
+
+void
+DataIndex::removeDeleted()
+{
+  // compact the entries, then place the remaining ones again with their new positions
+  std::vector<uint32_t> moved(m_entries.size(), 0);
+  size_t kept = 0;
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    if (m_entries[i].second == DELETED) {
+      record(m_entries[i].first, DELETED);
+      continue;
+    }
+    if (kept != i)
+      m_entries[kept] = m_entries[i];
+    moved[i] = ++kept;
+  }
+  if (kept == m_entries.size())
+    return;
+  m_entries.erase(m_entries.begin() + kept, m_entries.end());
+
+  std::vector<Slot> slots = clearSlots(m_slots.size());
+  for (std::vector<Slot>::const_iterator it = slots.begin(); it != slots.end(); ++it) {
+    if (it->entry != 0 && moved[it->entry - 1] != 0)
+      place(it->hash, moved[it->entry - 1]);
+  }
+}
+
+DataIndex::View
+DataIndex::freeze()
+{
+  if (!m_isModified && !m_epochs.empty()) {
+    View last = m_epochs.back().second.lock();
+    if (last)
+      return last;
+  }
+  // forget the epochs nobody holds any more, with the changes only they needed
+  while (!m_epochs.empty() && m_epochs.front().second.expired())
+    m_epochs.pop_front();
+  uint64_t oldest = (m_epochs.empty() ? m_epoch : m_epochs.front().first);
+  while (!m_changes.empty() && m_changes.front().epoch <= oldest)
+    m_changes.pop_front();
+
+  View view(new Epoch(*this, m_epoch));
+  m_epochs.push_back(std::make_pair(m_epoch, boost::weak_ptr<const Epoch>(view)));
+  m_epoch++;
+  m_isModified = false;
+  return view;
+}
+
+void
+DataIndex::record(const Name& name, status before)
+{
+  m_isModified = true;
+  if (m_epochs.empty())
+    return;
+  Change change = {m_epoch, name, before};
+  m_changes.push_back(change);
+}
+
+void
+DataIndex::getData(uint64_t epoch, Map& data) const
+{
+  // sort pointers to the entries, so that every name is copied once, at its final place
+  std::vector<const Entry*> sorted;
+  sorted.reserve(m_entries.size());
+  for (const_iterator it = begin(); it != end(); ++it)
+    sorted.push_back(&*it);
+  std::sort(sorted.begin(), sorted.end(), &compareNames);
+
+  data.clear();
+  for (std::vector<const Entry*>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+    data.insert(data.end(), **it);
+
+  // then undo the changes made after the epoch, the latest first
+  for (std::deque<Change>::const_reverse_iterator it = m_changes.rbegin();
+       it != m_changes.rend() && it->epoch > epoch; ++it) {
+    if (it->before == NONE)
+      data.erase(it->name);
+    else
+      data[it->name] = it->before;
+  }
+}
+
+void
+DataIndex::getChanges(uint64_t from, uint64_t to, Map& changes) const
+{
+  // the status of a name at an epoch is the one before its first change after the epoch,
+  // or its current status if it has not been changed since
+  Map before;
+  std::deque<Change>::const_iterator it = m_changes.begin();
+  for (; it != m_changes.end() && it->epoch <= to; ++it) {
+    if (it->epoch > from)
+      before.insert(std::make_pair(it->name, it->before));
+  }
+  Map after;
+  for (Map::const_iterator name = before.begin(); name != before.end(); ++name) {
+    const_iterator entry = find(name->first);
+    after.insert(after.end(), std::make_pair(name->first, entry == end() ? NONE : entry->second));
+  }
+  for (std::deque<Change>::const_reverse_iterator change = m_changes.rbegin();
+       change != m_changes.rend() && change->epoch > to; ++change) {
+    Map::iterator name = after.find(change->name);
+    if (name != after.end())
+      name->second = change->before;
+  }
+
+  changes.clear();
+  for (Map::const_iterator b = before.begin(), a = after.begin(); b != before.end(); ++b, ++a) {
+    if (b->second != a->second)
+      changes.insert(changes.end(), std::make_pair(a->first, a->second == NONE ? DELETED : a->second));
+  }
+}
+
+size_t
+DataIndex::hash(const Name& name)
+{
+  return NameHash()(name);
+}
+
+size_t
+DataIndex::findSlot(const Name& name, size_t hash) const
+{
+  size_t mask = m_slots.size() - 1;
+  size_t i = hash & mask;
+  while (m_slots[i].entry != 0 &&
+         (m_slots[i].hash != hash || m_entries[m_slots[i].entry - 1].first != name))
+    i = (i + 1) & mask;
+  return i;
+}
+
+std::vector<DataIndex::Slot>
+DataIndex::clearSlots(size_t count)
+{
+  Slot empty = {0, 0};
+  std::vector<Slot> slots(count, empty);
+  m_slots.swap(slots);
+  return slots;
+}
+
+void
+DataIndex::place(size_t hash, uint32_t entry)
+{
+  size_t mask = m_slots.size() - 1;
+  size_t i = hash & mask;
+  while (m_slots[i].entry != 0)
+    i = (i + 1) & mask;
+  m_slots[i].hash = hash;
+  m_slots[i].entry = entry;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_DATA_INDEX_HPP
+#define REPO_SYNC_DATA_INDEX_HPP
+
+#include "common.hpp"
+#include "action-entry.hpp"
+
+#include <deque>
+#include <vector>
+#include <boost/weak_ptr.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Status of the data names stored in the repository
+ *
+ * The entries are kept in insertion order and located through an open addressing table of
+ * name hashes, so a name is stored once and hashed once per lookup.  freeze() only closes an
+ * epoch of the index: while an epoch is held, the index records the previous status of the
+ * names it changes, and the content of the epoch, in name order, and the changes between
+ * two epochs are rebuilt from the entries and these records when they are requested.
+ */
+class DataIndex : noncopyable
+{
+public:
+  typedef std::pair<Name, status> Entry;
+  typedef std::vector<Entry>::const_iterator const_iterator;
+  typedef std::map<Name, status> Map;
+
+  /**
+   * @brief The content of the index when an epoch was closed
+   */
+  class Epoch : noncopyable
+  {
+  public:
+    /**
+     * @brief  the data of the index at this epoch, in name order
+     */
+    void
+    getData(Map& data) const
+    {
+      m_index.getData(m_number, data);
+    }
+
+    /**
+     * @brief  the names whose status changed from epoch 'base' to this one, a name that is
+     *         no longer in the index is reported as DELETED
+     */
+    void
+    getChanges(const Epoch& base, Map& changes) const
+    {
+      m_index.getChanges(base.m_number, m_number, changes);
+    }
+
+  private:
+    friend class DataIndex;
+
+    Epoch(const DataIndex& index, uint64_t number)
+      : m_index(index)
+      , m_number(number)
+    {
+    }
+
+  private:
+    const DataIndex& m_index;
+    uint64_t m_number;
+  };
+
+  typedef boost::shared_ptr<const Epoch> View;
+
+  DataIndex();
+
+  const_iterator
+  find(const Name& name) const;
+
+  const_iterator
+  begin() const
+  {
+    return m_entries.begin();
+  }
+
+  const_iterator
+  end() const
+  {
+    return m_entries.end();
+  }
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  /**
+   * @brief  add the data with the status unless it is already in the index, iterators are
+   *         invalidated when it is added
+   *
+   * @return the entry of the data and whether it has been added
+   */
+  std::pair<const_iterator, bool>
+  insert(const Name& name, status value);
+
+  /**
+   * @brief  change the status of an entry of the index
+   */
+  void
+  setStatus(const_iterator it, status value);
+
+  /**
+   * @brief  remove the entries of the deleted data
+   */
+  void
+  removeDeleted();
+
+  /**
+   * @brief  close the current epoch, an index that has not been modified since the last
+   *         epoch returns it again while it is held
+   */
+  View
+  freeze();
+
+private:
+  struct Slot
+  {
+    size_t hash;
+    uint32_t entry;                     // position in m_entries plus one, 0 for an empty slot
+  };
+
+  static size_t
+  hash(const Name& name);
+
+  /**
+   * @brief  the slot holding the name, or the empty slot where it belongs
+   */
+  size_t
+  findSlot(const Name& name, size_t hash) const;
+
+  /**
+   * @brief  replace the slots with 'count' empty ones
+   *
+   * @return the previous slots
+   */
+  std::vector<Slot>
+  clearSlots(size_t count);
+
+  /**
+   * @brief  put the entry into the first empty slot for its hash
+   */
+  void
+  place(size_t hash, uint32_t entry);
+
+  /**
+   * @brief  record the status of the name before a change, NONE if it was not in the index
+   */
+  void
+  record(const Name& name, status before);
+
+  void
+  getData(uint64_t epoch, Map& data) const;
+
+  void
+  getChanges(uint64_t from, uint64_t to, Map& changes) const;
+
+private:
+  struct Change
+  {
+    uint64_t epoch;
+    Name name;
+    status before;
+  };
+
+  static const size_t INITIAL_SLOTS = 16;
+
+  std::vector<Entry> m_entries;
+  std::vector<Slot> m_slots;            // a power of two, at most half of them are used
+  uint64_t m_epoch;                     // the epoch changes are made in
+  bool m_isModified;                    // since the last epoch was closed
+  std::deque<std::pair<uint64_t, boost::weak_ptr<const Epoch> > > m_epochs; // closed, oldest first
+  std::deque<Change> m_changes;         // made after the oldest epoch still held
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_DATA_INDEX_HPP
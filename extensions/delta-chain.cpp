@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "delta-chain.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+DeltaChain::DeltaChain(size_t length)
+  : m_length(length)
+  , m_version(0)
+{
+}
+
+void
+DeltaChain::setLength(size_t length)
+{
+  m_length = length;
+  while (m_bases.size() > m_length)
+    m_bases.pop_front();
+}
+
+void
+DeltaChain::append(uint64_t version, const DataIndex::View& data)
+{
+  if (m_length == 0) {
+    m_bases.clear();
+    m_state.reset();
+    m_version = version;
+    return;
+  }
+  // a gap in the versions makes the known snapshots useless
+  if (!m_state || version != m_version + 1)
+    m_bases.clear();
+  else
+  {
+    m_bases.push_back(m_state);
+    while (m_bases.size() > m_length)
+      m_bases.pop_front();
+  }
+  m_state = data;
+  m_version = version;
+}
+
+uint64_t
+DeltaChain::getFirstBase() const
+{
+  return m_version - m_bases.size();
+}
+
+bool
+DeltaChain::getChanges(uint64_t base, Changes& changes) const
+{
+  if (!m_state || base < getFirstBase() || base >= m_version)
+    return false;
+  m_state->getChanges(*m_bases[base - getFirstBase()], changes);
+  return true;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_DELTA_CHAIN_HPP
+#define REPO_SYNC_DELTA_CHAIN_HPP
+
+#include "common.hpp"
+#include "data-index.hpp"
+
+#include <deque>
+#include <map>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Changes of the repository between consecutive snapshots
+ *
+ * The chain keeps the epoch of the data index at the last snapshot and at most 'length'
+ * snapshots before it.  The changes since one of them are only worked out by the index when
+ * they are requested; a name that is no longer in the repository is reported as DELETED.  A
+ * repo that applied one of the snapshots of the chain only needs the changes since; an
+ * older one needs the full snapshot.
+ */
+class DeltaChain
+{
+public:
+  typedef std::map<Name, status> Changes;
+
+  explicit
+  DeltaChain(size_t length = 4);
+
+  /**
+   * @brief  number of snapshots the changes are known from, 0 to keep none
+   */
+  void
+  setLength(size_t length);
+
+  /**
+   * @brief  record the data of snapshot 'version', which follows the last recorded one
+   */
+  void
+  append(uint64_t version, const DataIndex::View& data);
+
+  /**
+   * @brief  the oldest snapshot the changes to the last snapshot are known from, equal to
+   *         the last version if there are none
+   */
+  uint64_t
+  getFirstBase() const;
+
+  /**
+   * @brief  the changes from snapshot 'base' to the last snapshot
+   * @return false if they are not known
+   */
+  bool
+  getChanges(uint64_t base, Changes& changes) const;
+
+private:
+  size_t m_length;
+  uint64_t m_version;                 // the last snapshot
+  DataIndex::View m_state;            // the data of the last snapshot
+  std::deque<DataIndex::View> m_bases; // the data of the snapshots before, oldest first
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_DELTA_CHAIN_HPP
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "fetch-dispatcher.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+FetchDispatcher::FetchDispatcher()
+  : m_budget(0)
+  , m_range(1)
+{
+}
+
+void
+FetchDispatcher::setParameters(uint32_t budget, uint32_t range)
+{
+  m_budget = budget;
+  m_range = (range > 0 ? range : 1);
+}
+
+bool
+FetchDispatcher::push(CreatorId creator, uint64_t from, uint64_t to)
+{
+  bool wasEmpty = m_queue.empty();
+  // a range that continues the last queued one of the creator extends it
+  if (!wasEmpty && m_queue.back().creator == creator && m_queue.back().to + 1 == from) {
+    m_queue.back().to = to;
+    return false;
+  }
+  Request request;
+  request.creator = creator;
+  request.from = from;
+  request.to = to;
+  m_queue.push_back(request);
+  return wasEmpty;
+}
+
+bool
+FetchDispatcher::dispatch(const SendFetch& send)
+{
+  for (uint32_t sent = 0; !m_queue.empty() && (m_budget == 0 || sent < m_budget); ++sent) {
+    // take the interest off the queue first, sending may queue more ranges
+    Request& request = m_queue.front();
+    CreatorId creator = request.creator;
+    uint64_t from = request.from;
+    uint64_t last = (request.to - from < m_range ? request.to : from + m_range - 1);
+    if (last == request.to)
+      m_queue.pop_front();
+    else
+      request.from = last + 1;
+
+    send(creator, from, last);
+  }
+  return !m_queue.empty();
+}
+
+} // namespace ndn
+} // namespace ns3
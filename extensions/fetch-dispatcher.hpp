@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_FETCH_DISPATCHER_HPP
+#define REPO_SYNC_FETCH_DISPATCHER_HPP
+
+#include "common.hpp"
+#include "creator-table.hpp"
+
+#include <deque>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Fetch interests waiting to be sent, drained once per tick
+ *
+ * The actions to fetch are queued as ranges of sequence numbers of a creator.  On every tick
+ * the queue is sent as fetch interests of at most 'range' actions each, in the order the
+ * ranges were queued.  A tick sends at most 'budget' interests; the rest of the queue is left
+ * to the following ticks.
+ */
+class FetchDispatcher : noncopyable
+{
+public:
+  typedef boost::function<void (CreatorId, uint64_t, uint64_t)> SendFetch;
+
+  FetchDispatcher();
+
+  /**
+   * @brief  set the number of interests sent per tick, 0 for no limit, and the number of
+   *         actions fetched by one interest
+   */
+  void
+  setParameters(uint32_t budget, uint32_t range);
+
+  /**
+   * @brief  queue the actions 'from' to 'to' of the creator, merged into the last queued
+   *         range when they follow it
+   * @return true if the queue was empty, i.e. a tick needs to be scheduled
+   */
+  bool
+  push(CreatorId creator, uint64_t from, uint64_t to);
+
+  /**
+   * @brief  send the interests of one tick
+   * @return true if ranges are left for the next tick
+   */
+  bool
+  dispatch(const SendFetch& send);
+
+  bool
+  empty() const
+  {
+    return m_queue.empty();
+  }
+
+private:
+  struct Request
+  {
+    CreatorId creator;
+    uint64_t from;
+    uint64_t to;
+  };
+
+private:
+  std::deque<Request> m_queue;
+  uint32_t m_budget;
+  uint32_t m_range;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_FETCH_DISPATCHER_HPP
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "fetch-window.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+FetchWindow::FetchWindow()
+  : m_initial(10)
+  , m_minimum(1)
+  , m_maximum(10)
+  , m_increase(1)
+  , m_decrease(0.5)
+{
+}
+
+void
+FetchWindow::setParameters(uint32_t initial, uint32_t minimum, uint32_t maximum,
+                           double increase, double decrease)
+{
+  m_minimum = (minimum > 0 ? minimum : 1);
+  m_maximum = (maximum > m_minimum ? maximum : m_minimum);
+  m_initial = std::min(std::max(static_cast<double>(initial), m_minimum), m_maximum);
+  m_increase = increase;
+  m_decrease = decrease;
+  m_entries.clear();
+}
+
+uint64_t
+FetchWindow::get(CreatorId creator) const
+{
+  if (creator >= m_entries.size())
+    return static_cast<uint64_t>(m_initial);
+  return static_cast<uint64_t>(m_entries[creator].window);
+}
+
+void
+FetchWindow::onAction(CreatorId creator)
+{
+  Entry& entry = getEntry(creator);
+  entry.window = std::min(entry.window + m_increase / entry.window, m_maximum);
+}
+
+void
+FetchWindow::onTimeout(CreatorId creator, uint64_t seq, uint64_t sending)
+{
+  Entry& entry = getEntry(creator);
+  if (seq <= entry.recover)
+    return;
+  entry.window = std::max(entry.window * m_decrease, m_minimum);
+  entry.recover = sending;
+}
+
+FetchWindow::Entry&
+FetchWindow::getEntry(CreatorId creator)
+{
+  if (creator >= m_entries.size()) {
+    Entry entry;
+    entry.window = m_initial;
+    entry.recover = 0;
+    m_entries.resize(creator + 1, entry);
+  }
+  return m_entries[creator];
+}
+
+} // namespace ndn
+} // namespace ns3
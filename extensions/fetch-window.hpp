@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_FETCH_WINDOW_HPP
+#define REPO_SYNC_FETCH_WINDOW_HPP
+
+#include "common.hpp"
+#include "creator-table.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Per creator AIMD window of actions that may be fetched at the same time
+ *
+ * Every fetched action grows the window by increase / window, i.e. by 'increase' actions
+ * per round trip.  A fetch timeout shrinks it by the decrease factor, at most once per
+ * window: timeouts of actions that were requested before the last decrease are ignored.
+ */
+class FetchWindow
+{
+public:
+  FetchWindow();
+
+  /**
+   * @param initial   window of a creator before any action of it is fetched
+   * @param minimum   lower bound of the window
+   * @param maximum   upper bound of the window
+   * @param increase  actions added to the window per round trip
+   * @param decrease  factor applied to the window on timeout
+   */
+  void
+  setParameters(uint32_t initial, uint32_t minimum, uint32_t maximum,
+                double increase, double decrease);
+
+  /**
+   * @brief  number of actions of the creator that may be on the way
+   */
+  uint64_t
+  get(CreatorId creator) const;
+
+  /**
+   * @brief  an action of the creator has been fetched
+   */
+  void
+  onAction(CreatorId creator);
+
+  /**
+   * @brief  fetching the action 'seq' of the creator timed out
+   * @param  sending  the last action of the creator that has been requested
+   */
+  void
+  onTimeout(CreatorId creator, uint64_t seq, uint64_t sending);
+
+private:
+  struct Entry
+  {
+    double window;
+    uint64_t recover;   // timeouts up to this action belong to the last decrease
+  };
+
+  Entry&
+  getEntry(CreatorId creator);
+
+private:
+  double m_initial;
+  double m_minimum;
+  double m_maximum;
+  double m_increase;
+  double m_decrease;
+  std::vector<Entry> m_entries;  // indexed by creator id
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_FETCH_WINDOW_HPP
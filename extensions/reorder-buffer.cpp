@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "reorder-buffer.hpp"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+
+static const size_t INITIAL_CAPACITY = 64;
+
+ReorderBuffer::ReorderBuffer()
+  : m_next(1)
+  , m_taken(0)
+  , m_count(0)
+  , m_slots(INITIAL_CAPACITY)
+  , m_bitmap(INITIAL_CAPACITY / 64, 0)
+{
+}
+
+void
+ReorderBuffer::advance(uint64_t current)
+{
+  if (current + 1 < m_next) {
+    clear();
+    m_next = current + 1;
+    m_taken = current;
+    return;
+  }
+  if (m_count == 0 || current + 1 - m_next >= m_slots.size()) {
+    clear();
+    m_next = current + 1;
+    return;
+  }
+  while (m_next <= current) {
+    erase(m_next);
+    ++m_next;
+  }
+}
+
+bool
+ReorderBuffer::insert(const ActionEntry& action)
+{
+  uint64_t seq = action.getSeqNo();
+  if (seq < m_next)
+    throw Error("Action is before the reorder window");
+  if (seq - m_next >= m_slots.size())
+    grow(seq);
+
+  size_t index = slot(seq);
+  if (test(index))
+    return false;
+  m_slots[index] = action;
+  m_bitmap[index / 64] |= (uint64_t(1) << (index % 64));
+  ++m_count;
+  return true;
+}
+
+bool
+ReorderBuffer::hasNext() const
+{
+  return m_count > 0 && test(slot(m_next));
+}
+
+const ActionEntry&
+ReorderBuffer::next() const
+{
+  return *m_slots[slot(m_next)];
+}
+
+void
+ReorderBuffer::popNext()
+{
+  erase(m_next);
+  ++m_next;
+}
+
+uint64_t
+ReorderBuffer::first() const
+{
+  if (m_count == 0)
+    return 0;
+
+  // scan the bitmap from the slot of m_next, wrapping around once
+  size_t capacity = m_slots.size();
+  size_t start = slot(m_next);
+  size_t scanned = 0;
+  while (scanned < capacity) {
+    size_t index = (start + scanned) & (capacity - 1);
+    uint64_t word = m_bitmap[index / 64] >> (index % 64);
+    if (word != 0)
+      return m_next + scanned + __builtin_ctzll(word);
+    scanned += 64 - index % 64;
+  }
+  return 0;
+}
+
+std::pair<uint64_t, uint64_t>
+ReorderBuffer::takeGap()
+{
+  uint64_t from = (m_taken + 1 > m_next ? m_taken + 1 : m_next);
+  uint64_t firstSeq = first();
+  if (firstSeq == 0 || firstSeq <= from)
+    return std::make_pair(uint64_t(1), uint64_t(0));
+
+  m_taken = firstSeq - 1;
+  return std::make_pair(from, firstSeq - 1);
+}
+
+void
+ReorderBuffer::clear()
+{
+  if (m_count > 0) {
+    std::fill(m_slots.begin(), m_slots.end(), boost::none);
+    std::fill(m_bitmap.begin(), m_bitmap.end(), 0);
+    m_count = 0;
+  }
+}
+
+void
+ReorderBuffer::erase(uint64_t seq)
+{
+  size_t index = slot(seq);
+  if (!test(index))
+    return;
+  m_slots[index] = boost::none;
+  m_bitmap[index / 64] &= ~(uint64_t(1) << (index % 64));
+  --m_count;
+}
+
+void
+ReorderBuffer::grow(uint64_t seq)
+{
+  size_t capacity = m_slots.size();
+  while (seq - m_next >= capacity)
+    capacity *= 2;
+
+  std::vector<boost::optional<ActionEntry> > slots(capacity);
+  std::vector<uint64_t> bitmap(capacity / 64, 0);
+  for (size_t index = 0; index < m_slots.size(); ++index) {
+    if (!test(index))
+      continue;
+    size_t newIndex = static_cast<size_t>(m_slots[index]->getSeqNo()) & (capacity - 1);
+    slots[newIndex] = m_slots[index];
+    bitmap[newIndex / 64] |= (uint64_t(1) << (newIndex % 64));
+  }
+  m_slots.swap(slots);
+  m_bitmap.swap(bitmap);
+}
+
+} // namespace ndn
+} // namespace ns3
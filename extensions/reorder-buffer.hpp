@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef REPO_SYNC_REORDER_BUFFER_HPP
+#define REPO_SYNC_REORDER_BUFFER_HPP
+
+#include "common.hpp"
+#include "action-entry.hpp"
+
+#include <boost/optional.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Actions of one creator that arrived before the actions preceding them
+ *
+ * The buffer is a sliding window over sequence numbers starting at the next action to
+ * apply.  Slots are addressed by sequence number modulo the capacity, which doubles when
+ * an action falls outside the window, and a bitmap marks the occupied slots, so inserting,
+ * duplicate detection and in order draining take constant time and gaps are found a word
+ * at a time.
+ */
+class ReorderBuffer
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  ReorderBuffer();
+
+  /**
+   * @brief  the actions up to 'current' have been applied, drop them from the window
+   *
+   * Moving the window back, e.g. after the creator has been reset, empties the buffer.
+   */
+  void
+  advance(uint64_t current);
+
+  /**
+   * @brief  buffer an action after the next one to apply
+   * @return false if the action is buffered already
+   */
+  bool
+  insert(const ActionEntry& action);
+
+  /**
+   * @brief  whether the next action to apply is buffered
+   */
+  bool
+  hasNext() const;
+
+  const ActionEntry&
+  next() const;
+
+  /**
+   * @brief  the next action has been applied, move the window past it
+   */
+  void
+  popNext();
+
+  /**
+   * @brief  sequence number of the first buffered action, 0 if the buffer is empty
+   */
+  uint64_t
+  first() const;
+
+  /**
+   * @brief  missing actions before the first buffered one that have not been taken yet
+   * @return the first and the last sequence number of the gap, first > last if there is none
+   */
+  std::pair<uint64_t, uint64_t>
+  takeGap();
+
+  bool
+  empty() const
+  {
+    return m_count == 0;
+  }
+
+  size_t
+  size() const
+  {
+    return m_count;
+  }
+
+  void
+  clear();
+
+private:
+  size_t
+  slot(uint64_t seq) const
+  {
+    return static_cast<size_t>(seq) & (m_slots.size() - 1);
+  }
+
+  bool
+  test(size_t slot) const
+  {
+    return (m_bitmap[slot / 64] >> (slot % 64)) & 1;
+  }
+
+  void
+  erase(uint64_t seq);
+
+  void
+  grow(uint64_t seq);
+
+private:
+  uint64_t m_next;      // sequence number of the next action to apply
+  uint64_t m_taken;     // gaps up to this sequence number have been taken
+  size_t m_count;
+  std::vector<boost::optional<ActionEntry> > m_slots;  // size is a power of two
+  std::vector<uint64_t> m_bitmap;                      // one bit per slot
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_REORDER_BUFFER_HPP
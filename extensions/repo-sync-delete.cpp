@@ -45,19 +45,6 @@ const int syncResponseFreshness = 1000;
 const int syncInterestReexpress = 4;
 const int defaultRecoveryRetransmitInterval = 200; // milliseconds
 const int retrytimes = 4;
-const int pipeline = 100;
-
-static bool
-compareDigest(std::pair<DigestPtr, ActionEntry> entry, DigestConstPtr digest)
-{
-  return *entry.first == *digest;
-}
-
-static bool
-compareActionEntry(std::pair<DigestPtr, ActionEntry> entry, const Name& name)
-{
-  return entry.second.getName() == name;
-}
 
 static bool
 compareSnapshot(std::pair<Name, uint64_t> entry, std::pair<Name, uint64_t> info)
@@ -65,12 +52,6 @@ compareSnapshot(std::pair<Name, uint64_t> entry, std::pair<Name, uint64_t> info)
   return entry == info;
 }
 
-static bool
-compareSeq(ActionEntry test, uint64_t seq)
-{
-  return test.getSeqNo() == seq;
-}
-
 RepoSyncDelete::RepoSyncDelete()
   : m_seq(0)    // action sequence initiate as 0, the first action sequence is 1
   , m_isSynchronized(false)
@@ -82,8 +63,9 @@ RepoSyncDelete::RepoSyncDelete()
   , m_reexpressionJitter(m_randomGenerator, boost::uniform_int<>(100,500))
   , m_senddataJitter(m_randomGenerator, boost::uniform_int<>(100,200))
   , m_syncInterestTable(ns3::Seconds(syncInterestReexpress))
-  , m_snapshot(SyncStateMsg::SNAPSHOT)
   , m_snapshotNo(0)
+  , m_encoding(Msg::PLAIN)
+  , m_snapshotSegmentSize(0)
   , m_size(0)
   , m_count(0)
   , preSeq(1)
@@ -99,11 +81,44 @@ RepoSyncDelete::~RepoSyncDelete()
 void
 RepoSyncDelete::init()
 {
-  m_actionList.clear();
+  m_actionLog.clear();
   Name rootName("/");
   ActionEntry entry(rootName, -1);
-  m_actionList.push_back(std::make_pair(m_syncTree.getDigest(), entry));
+  logAction(entry);
+  createSnapshot();
+  // every action left the log, only the snapshot can serve them
+  m_syncTree.updateForSnapshot();
+  m_evictedSeqs.clear();
+}
+
+void
+RepoSyncDelete::logAction(const ActionEntry& entry)
+{
+  m_actionLog.append(m_syncTree.getDigest(), entry);
+}
+
+void
+RepoSyncDelete::onActionsEvicted(size_t count, const ActionLog::EvictedSeqs& seqs)
+{
+  // actions that are no longer in the log can only be served through the snapshot, so
+  // regenerate it once the current event is done, instead of resetting the whole log
+  NS_LOG_DEBUG("evicted " << count << " actions from the action log");
+  for (ActionLog::EvictedSeqs::const_iterator it = seqs.begin(); it != seqs.end(); ++it) {
+    uint64_t& seq = m_evictedSeqs[it->first];
+    if (seq < it->second)
+      seq = it->second;
+  }
+  m_scheduler.cancel(EVICT_ACTIONS);
+  m_scheduler.schedule(ns3::Seconds(0), bind(&RepoSyncDelete::snapshotEvictedActions, this), EVICT_ACTIONS);
+}
+
+void
+RepoSyncDelete::snapshotEvictedActions()
+{
   createSnapshot();
+  for (ActionLog::EvictedSeqs::const_iterator it = m_evictedSeqs.begin(); it != m_evictedSeqs.end(); ++it)
+    m_syncTree.updateForEviction(it->first, it->second);
+  m_evictedSeqs.clear();
 }
 
 Action
@@ -125,6 +140,16 @@ RepoSyncDelete::strToAction(const std::string& action)
 void
 RepoSyncDelete::StartApplication()
 {
+  m_scheduler.setTick(m_schedulerTick);
+  m_syncTree.setDigestMode(SyncTree::strToDigestMode(m_digestMode));
+  m_encoding = Msg::strToEncoding(m_msgEncoding);
+  m_snapshotFetcher.setWindow(m_snapshotWindow);
+  m_deltaChain.setLength(m_snapshotDeltas);
+  m_actionLog.setBudget(m_actionLogBudget);
+  m_fetchWindow.setParameters(m_windowInitial, m_windowMin, m_windowMax,
+                              m_windowIncrease, m_windowDecrease);
+  m_fetchDispatcher.setParameters(m_fetchBudget, m_fetchRange);
+  m_actionLog.onEviction(bind(&RepoSyncDelete::onActionsEvicted, this, _1, _2));
   m_scheduler.schedule(ns3::MilliSeconds(m_start), 
                          bind(&RepoSyncDelete::start, this),
                          START);
@@ -133,7 +158,7 @@ RepoSyncDelete::StartApplication()
 void
 RepoSyncDelete::StopApplication()
 {
-  m_ccnxHandle->clearInterestFilter (m_syncPrefix.toUri());
+  m_ccnxHandle->clearInterestFilter (m_syncPrefix);
   m_ccnxHandle->StopApplication ();
   m_scheduler.cancel(REEXPRESSING_INTEREST);
   m_scheduler.cancel(DELAYED_INTEREST_PROCESSING);
@@ -146,24 +171,19 @@ RepoSyncDelete::start()
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") m_master : " << m_master<<"  creator name = "<<m_creatorName);
   if (m_master != "0")
   {
-
-    for(uint64_t k=0; k<1000; k++)
-    { 
-      
-      Name dataName("/data");
-      dataName.appendSeqNum(k);
-      //std::cout<<"data name "<<dataName<<std::endl;
-      m_scheduler.schedule(ns3::MilliSeconds(4000), bind(&RepoSyncDelete::insertAction, this, dataName, "insertion"), GENERATE_ACTION);
-      m_scheduler.schedule(ns3::MilliSeconds(6000), bind(&RepoSyncDelete::insertAction, this, dataName, "deletion"), 300);
-    }
-     m_scheduler.schedule(ns3::MilliSeconds(4000), bind(&RepoSyncDelete::processPendingSyncInterests, this), 102);
-    
+    // the data are deleted in the same order they are inserted
+    startWorkload(WorkloadSource::create(m_workload, m_workloadPrefix, m_workloadCount,
+                                         m_workloadInterval, m_workloadTrace),
+                  m_workloadStart, GENERATE_ACTION);
+    startWorkload(WorkloadSource::create(m_workload, m_workloadPrefix, m_workloadCount,
+                                         m_workloadInterval, m_workloadTrace, "deletion"),
+                  ns3::MilliSeconds(6000), 300);
+    m_scheduler.schedule(m_workloadStart, bind(&RepoSyncDelete::processPendingSyncInterests, this), 102);
   }
 
   m_ccnxHandle->SetNode (GetNode ());
   m_ccnxHandle->StartApplication ();
-  std::string str = "/";
-  m_ccnxHandle->setInterestFilter (str,
+  m_ccnxHandle->setInterestFilter (Name("/"),
                                    bind(&RepoSyncDelete::onSyncInterest, this, _1),
                                    bind(&RepoSyncDelete::setFilterTimeout, this, _1));
   
@@ -177,7 +197,7 @@ RepoSyncDelete::start()
 void
 RepoSyncDelete::stop()
 {
-  m_ccnxHandle->clearInterestFilter (m_syncPrefix.toUri());
+  m_ccnxHandle->clearInterestFilter (m_syncPrefix);
   m_scheduler.cancel(REEXPRESSING_INTEREST);
   m_scheduler.cancel(DELAYED_INTEREST_PROCESSING);
   for (int i=0; i<4; i++)
@@ -213,40 +233,173 @@ RepoSyncDelete::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor(&RepoSyncDelete::m_start),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("DigestMode", "How the root digest is maintained: full, incremental or deferred",
+                   StringValue("full"),
+                   MakeStringAccessor(&RepoSyncDelete::m_digestMode),
+                   MakeStringChecker())
+    .AddAttribute("MsgEncoding", "How action names and snapshots are encoded in replies: plain or compact",
+                   StringValue("compact"),
+                   MakeStringAccessor(&RepoSyncDelete::m_msgEncoding),
+                   MakeStringChecker())
+    .AddAttribute("ActionLogBudget", "Maximum number of actions kept in the action log, 0 for unbounded",
+                   UintegerValue (0),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_actionLogBudget),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("FetchRange", "Maximum number of actions fetched by one interest",
+                   UintegerValue (10),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_fetchRange),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute("FetchWindow", "Initial number of actions of a creator fetched at the same time",
+                   UintegerValue (100),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_windowInitial),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute("FetchWindowMin", "Lower bound of the fetch window",
+                   UintegerValue (1),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_windowMin),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute("FetchWindowMax", "Upper bound of the fetch window",
+                   UintegerValue (500),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_windowMax),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute("FetchWindowIncrease", "Number of actions added to the fetch window per round trip",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor(&RepoSyncDelete::m_windowIncrease),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute("FetchWindowDecrease", "Factor applied to the fetch window when a fetch interest times out",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor(&RepoSyncDelete::m_windowDecrease),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute("FetchTick", "Interval at which the queued fetch interests are sent",
+                   StringValue("0ms"),
+                   MakeTimeAccessor(&RepoSyncDelete::m_fetchTick),
+                   MakeTimeChecker())
+    .AddAttribute("FetchBudget", "Number of queued fetch interests sent per tick, 0 for no limit",
+                   UintegerValue (0),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_fetchBudget),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("SyncReplyBudget", "Bytes of whole actions embedded in a sync reply, 0 only sends action names",
+                   UintegerValue (0),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_syncReplyBudget),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("SnapshotSegmentSize", "Bytes of data in one segment of a snapshot, 0 to send the snapshot in one piece",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_snapshotSegmentSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("SnapshotWindow", "Number of segments of a snapshot fetched at the same time",
+                   UintegerValue (8),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_snapshotWindow),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute("SnapshotDeltas", "Number of earlier snapshots the changes to a snapshot are published from, 0 for none",
+                   UintegerValue (4),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_snapshotDeltas),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("SchedulerTick", "Events are delayed to the end of their tick and fired together, 0 to fire them at their exact time",
+                   StringValue("0s"),
+                   MakeTimeAccessor(&RepoSyncDelete::m_schedulerTick),
+                   MakeTimeChecker())
+    .AddAttribute("Workload", "Actions generated by the master: burst, poisson or trace",
+                   StringValue("burst"),
+                   MakeStringAccessor(&RepoSyncDelete::m_workload),
+                   MakeStringChecker())
+    .AddAttribute("WorkloadPrefix", "Prefix of the data generated by the master",
+                   StringValue("/data"),
+                   MakeNameAccessor(&RepoSyncDelete::m_workloadPrefix),
+                   MakeNameChecker())
+    .AddAttribute("WorkloadCount", "Number of actions of a burst or poisson workload",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor(&RepoSyncDelete::m_workloadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute("WorkloadStart", "Time the workload starts at, from the start of sync",
+                   StringValue("4s"),
+                   MakeTimeAccessor(&RepoSyncDelete::m_workloadStart),
+                   MakeTimeChecker())
+    .AddAttribute("WorkloadInterval", "Time between the actions of a burst, mean time between the actions of a poisson workload",
+                   StringValue("0s"),
+                   MakeTimeAccessor(&RepoSyncDelete::m_workloadInterval),
+                   MakeTimeChecker())
+    .AddAttribute("WorkloadTrace", "Trace file of a trace workload",
+                   StringValue(""),
+                   MakeStringAccessor(&RepoSyncDelete::m_workloadTrace),
+                   MakeStringChecker())
     ;
   
   return tid;
 }
 
+void
+RepoSyncDelete::startWorkload(boost::shared_ptr<WorkloadSource> workload, const Time& start, uint32_t label)
+{
+  if (workload->next())
+    m_scheduler.schedule(start + workload->getTime(), bind(&RepoSyncDelete::generateActions, this, workload, label), label);
+}
+
+void
+RepoSyncDelete::generateActions(boost::shared_ptr<WorkloadSource> workload, uint32_t label)
+{
+  // the actions due at the same time are generated by one event and committed as one batch
+  Time time = workload->getTime();
+  ActionBatch batch;
+  bool hasNext;
+  do {
+    batch.push_back(std::make_pair(workload->getDataName(), workload->getAction()));
+    hasNext = workload->next();
+  } while (hasNext && workload->getTime() == time);
+  insertActions(batch);
+
+  if (hasNext)
+    m_scheduler.schedule(workload->getTime() - time, bind(&RepoSyncDelete::generateActions, this, workload, label), label);
+}
+
 // insert action into actionlist from repo handles
 void
 RepoSyncDelete::insertAction(const Name& dataName, const std::string& str)
 {
   
-  m_seq++;
-  Action action = strToAction(str);
-  ActionEntry entry(m_creatorName, dataName, action);
-  uint64_t version = ++m_seqIndex[std::make_pair(dataName, action)];
-  entry.setVersion(version);
-  entry.setSeqNo(m_seq);
-  entry.constructName();
-  m_syncTree.update(entry);
-  m_actionList.push_back(std::make_pair(m_syncTree.getDigest(), entry));
-  m_nodeSeq[m_creatorName].current = m_seq;
-  m_nodeSeq[m_creatorName].final = m_seq;
-  std::map<Name, status>::iterator it = m_storageHandle.find(dataName);
-  if (str == "insertion")
-  {
-    if (it == m_storageHandle.end())
-      m_storageHandle[dataName] = EXISTED;
-    else if (m_storageHandle[dataName] == DELETED) 
-      m_storageHandle[dataName] = INSERTED;
-  }
-  else
-  {
-    if (it != m_storageHandle.end() && it->second == EXISTED)
-      m_storageHandle[dataName] = DELETED;    
+  insertActions(ActionBatch(1, std::make_pair(dataName, str)));
+}
+
+void
+RepoSyncDelete::insertActions(const ActionBatch& batch)
+{
+  if (batch.empty())
+    return;
+  // the actions before the last one are logged under the digest of the last entry, which
+  // keeps pointing at that entry, so the whole batch is handed to a repo still at that digest
+  DigestValue previous = (m_actionLog.end() - 1)->first;
+  m_actionLog.reserve(batch.size());
+  for (ActionBatch::const_iterator item = batch.begin(); item != batch.end(); ++item) {
+    const Name& dataName = item->first;
+    const std::string& str = item->second;
+    m_seq++;
+    Action action = strToAction(str);
+    ActionEntry entry(m_creatorName, dataName, action);
+    uint64_t version = ++m_seqIndex[std::make_pair(dataName, action)];
+    entry.setVersion(version);
+    entry.setSeqNo(m_seq);
+    entry.constructName();
+    if (item + 1 != batch.end())
+      m_actionLog.append(previous, entry);
+    else {
+      // the tree entry of a creator only holds its last action
+      m_syncTree.update(entry);
+      logAction(entry);
+    }
+    if (str == "insertion")
+    {
+      std::pair<DataIndex::const_iterator, bool> inserted = m_storageHandle.insert(dataName, EXISTED);
+      if (!inserted.second && inserted.first->second == DELETED)
+        m_storageHandle.setStatus(inserted.first, INSERTED);
+    }
+    else
+    {
+      DataIndex::const_iterator it = m_storageHandle.find(dataName);
+      if (it != m_storageHandle.end() && it->second == EXISTED)
+        m_storageHandle.setStatus(it, DELETED);
+    }
   }
+  pipelineEntrySeq& node = getNodeSeq(CreatorTable::getInstance().intern(m_creatorName));
+  node.current = m_seq;
+  node.final = m_seq;
   //m_scheduler.schedule(ns3::MilliSeconds(0.01), bind(&RepoSyncDelete::processPendingSyncInterests, this), 102);
   
 }
@@ -256,18 +409,18 @@ RepoSyncDelete::printDistribution()
 {
   uint64_t size = 0;
   uint64_t m_size = 1000;
-  for (std::map<Name, status>::iterator it = m_storageHandle.begin(); it != m_storageHandle.end(); it++)
+  for (DataIndex::const_iterator it = m_storageHandle.begin(); it != m_storageHandle.end(); it++)
   {
     if (it->second == EXISTED || it->second == INSERTED)
       size++;
   }
 
   /*
-  if (m_actionList.size() > preSeq)
+  if (m_actionLog.size() > preSeq)
   {
     
-    NS_LOG_INFO ("node("<< GetNode()->GetId() <<") "<<m_count*20<<" ms cumulate "<<(m_actionList.size() - preSeq)<<" action");
-    preSeq = m_actionList.size();
+    NS_LOG_INFO ("node("<< GetNode()->GetId() <<") "<<m_count*20<<" ms cumulate "<<(m_actionLog.size() - preSeq)<<" action");
+    preSeq = m_actionLog.size();
   }*/
   //if (size < m_size)
   {
@@ -298,11 +451,10 @@ RepoSyncDelete::printSyncStatus(const Name& name)
 }
 
 void
-RepoSyncDelete::onSyncInterest(const std::string &str)
+RepoSyncDelete::onSyncInterest(const Name &name)
 {
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") interest name : " << m_storageHandle.size());
   //std::cout<<"on sync interest"<<std::endl;
-  Name name(str);
   Name dataName("/data");
   if (dataName.isPrefixOf(name))
   {
@@ -313,23 +465,29 @@ RepoSyncDelete::onSyncInterest(const std::string &str)
   // syncInterest /ndn/broadcast/sync/digest
   // fetchInterest /ndn/broadcast/fetch/creatorName/seq
   // recoveryInterest /ndn/broadcast/recovery/digest
+  // snapshotInterest /ndn/broadcast/snapshot/creatorName/version/segment
+  // deltaInterest /ndn/broadcast/delta/creatorName/version/base/segment
   BOOST_ASSERT(nameLengthDiff > 1);
   try
     {
       std::string type = name[m_syncPrefix.size()].toUri();
       if (type == "sync")
         {
-          DigestConstPtr digest = convertNameToDigest(name);
+          DigestValue digest = convertNameToDigest(name);
           processSyncInterest(name, digest, false);
         }
-      else if (type == "fetch")
+      else if (type == "fetch" || type == "range")
         {
           processFetchInterest(name);
         }
+      else if (type == "snapshot" || type == "delta")
+        {
+          processSnapshotInterest(name);
+        }
       else if (type == "recovery")
         {
           //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") receive recovery intereest "<<name);
-          DigestConstPtr digest = convertNameToDigest(name);
+          DigestValue digest = convertNameToDigest(name);
           processRecoveryInterest(name, digest);
         }
        else
@@ -348,7 +506,7 @@ void
 RepoSyncDelete::responseData(const Name& prefix)
 {
   
-  std::map<Name, status>::iterator it = m_storageHandle.find(prefix);
+  DataIndex::const_iterator it = m_storageHandle.find(prefix);
   ////NS_LOG_INFO ("node("<< GetNode()->GetId() <<") data status : "<<prefix<<" status "<<it->second);
   if (it != m_storageHandle.end() && (it->second == EXISTED || it->second == INSERTED))
   {
@@ -358,34 +516,34 @@ RepoSyncDelete::responseData(const Name& prefix)
   }
 }
 
-DigestConstPtr
+DigestValue
 RepoSyncDelete::convertNameToDigest(const Name &name)
 {
   BOOST_ASSERT(m_syncPrefix.isPrefixOf(name));
 
   std::string hash = name.get(-1).toUri();
 
-  DigestPtr digest = boost::make_shared<Digest>();
+  DigestValue digest;
   std::istringstream is(hash);
-  is >> *digest;
+  is >> digest;
 
   return digest;
 }
 
 void
-RepoSyncDelete::processSyncInterest(const Name& name, DigestConstPtr digest, bool timeProcessing)
+RepoSyncDelete::processSyncInterest(const Name& name, const DigestValue& digest, bool timeProcessing)
 {
-  DigestConstPtr rootDigest = m_syncTree.getDigest();
+  const DigestValue& rootDigest = m_syncTree.getDigest();
   //if (GetNode()->GetId() == 0)
-  //std::cout<<m_creatorName<<" process sync interest m_digest = "<<*rootDigest<<" received digest = "<<*digest<<std::endl;
+  //std::cout<<m_creatorName<<" process sync interest m_digest = "<<rootDigest<<" received digest = "<<digest<<std::endl;
   //if (GetNode()->GetId() == 1 || GetNode()->GetId() == 35)
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process sync interest name "<<name);
-  if (*rootDigest == *digest) {
+  if (rootDigest == digest) {
     if (!m_isSynchronized) {
       m_scheduler.cancel(SYNCHRONIZED);
       //remove actions when no different digest received for a while
       m_scheduler.schedule(ns3::Seconds(20), bind(&RepoSyncDelete::removeActions, this), SYNCHRONIZED);
-      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") synced digest "<<*rootDigest);
+      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") synced digest "<<rootDigest);
       m_isSynchronized = true;
     }
     m_syncInterestTable.insert(digest, name.toUri(), false);
@@ -394,17 +552,15 @@ RepoSyncDelete::processSyncInterest(const Name& name, DigestConstPtr digest, boo
   // if received a different digest, cancel the event of removeActions
   m_scheduler.cancel(SYNCHRONIZED);
   m_isSynchronized = false;
-  std::list<std::pair<DigestPtr, ActionEntry> >::iterator it = std::find_if(m_actionList.begin(),
-                                                                            m_actionList.end(),
-                                                                            bind(&compareDigest, _1, digest));
+  ActionLog::const_iterator it = m_actionLog.find(digest);
   // if the digest can be recognized, it means that the digest of the sender repo is outdated
   // return all the missing actions to the sender repo so that it can start to fetch the actions
-  if (it != m_actionList.end()) {
-    Msg message(SyncStateMsg::ACTION);
-    ++it;
-    while (it != m_actionList.end()) {
-      message.writeActionNameToMsg(it->second);
-      ++it;
+  if (it != m_actionLog.end()) {
+    Msg message(SyncStateMsg::ACTION, m_encoding);
+    // whole actions are embedded up to the budget, so that a small delta skips the fetch round trip
+    size_t budget = m_syncReplyBudget;
+    BOOST_FOREACH(const ActionLog::Entry& entry, m_actionLog.entriesAfter(it)) {
+      message.writeActionToMsg(entry.second, budget);
     }
     //m_scheduler.schedule(ns3::MilliSeconds(m_senddataJitter()), bind(&RepoSyncDelete::sendData, this, name, message), 100);
     sendData(name, message);
@@ -442,45 +598,49 @@ RepoSyncDelete::processFetchInterest(const Name& name)
   
   m_isSynchronized = false;
   m_scheduler.cancel(SYNCHRONIZED);
-  Name actionName = name.getSubName(m_syncPrefix.size() + 1);
-  //std::string seqNo = actionName.get(-1).to
-  uint64_t seq = actionName.get(-1).toSeqNum();
-  Name creator = actionName.getSubName(0, actionName.size() - 1);
+  Name creator;
+  uint64_t from, to;
+  parseFetchName(name, creator, from, to);
   //std::cout<<m_creatorName<<" process Fetch interest name = "<<name<<std::endl;
   // check the sync tree to get the status of action's creator
   // if the requested action is removed, return the snapshot
-  // Otherwise, send the action back
+  // Otherwise, send the actions back
   SyncTree::const_iter iterator = m_syncTree.lookup(creator);
-  //std::cout<<" before send snapshot creator = "<<creator<<" seq = "<<seq<<" first = "<<iterator->second.first<<std::endl;
-  if (iterator != m_syncTree.end() && seq <= iterator->second.first && iterator->second.first != 0) {
+  //std::cout<<" before send snapshot creator = "<<creator<<" seq = "<<from<<" first = "<<iterator->second.first<<std::endl;
+  if (iterator != m_syncTree.end() && from <= iterator->second.first && iterator->second.first != 0) {
     sendSnapshot(name);
     return;
   }
-  std::list<std::pair<DigestPtr, ActionEntry> >::iterator it =
-                                        std::find_if(m_actionList.begin(), m_actionList.end(),
-                                                     bind(&compareActionEntry, _1, actionName));
-
-  if (it != m_actionList.end()) {
-    Msg message(SyncStateMsg::ACTION);
+  // answer with the requested actions up to the first one missing in the log,
+  // the requester fetches the rest of the range again
+  CreatorId creatorId = CreatorTable::getInstance().intern(creator);
+  Msg message(SyncStateMsg::ACTION, m_encoding);
+  uint64_t seq = from;
+  for (; seq <= to; ++seq) {
+    ActionLog::const_iterator it = m_actionLog.find(creatorId, seq);
+    if (it == m_actionLog.end())
+      break;
     message.writeActionToMsg(it->second);
-    //m_scheduler.schedule(ns3::MilliSeconds(m_senddataJitter()), bind(&RepoSyncDelete::sendData, this, name, message), 100);
+  }
 
+  if (seq != from) {
+    //m_scheduler.schedule(ns3::MilliSeconds(m_senddataJitter()), bind(&RepoSyncDelete::sendData, this, name, message), 100);
     sendData(name, message);
   }
 }
 
 void
-RepoSyncDelete::processRecoveryInterest(const Name& name, DigestConstPtr digest)
+RepoSyncDelete::processRecoveryInterest(const Name& name, const DigestValue& digest)
 {
   //std::cout<<"process recovery interest"<<std::endl;
   // if received recovery interest, the group is not synchronized, cancel the event of removeActions
   //if (GetNode()->GetId() == 11)
-  DigestConstPtr rootDigest = m_syncTree.getDigest();
+  const DigestValue& rootDigest = m_syncTree.getDigest();
     std::ostringstream os;
-  os << *m_syncTree.getDigest();
+  os << m_syncTree.getDigest();
   
   m_outstandingInterestName.append("sync").append(os.str());
-  //if (*rootDigest != *digest) 
+  //if (rootDigest != digest) 
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process recovery interest "<<name<<" local digest = "<<os.str());
 
   m_isSynchronized = false;
@@ -488,12 +648,9 @@ RepoSyncDelete::processRecoveryInterest(const Name& name, DigestConstPtr digest)
   // check into action list to see whether this digest has once appeared or not
   // if the digest can be recognized, send back the current status of all the known nodes
   // Otherwise, ignore this interest
-  std::list<std::pair<DigestPtr, ActionEntry> >::iterator it = std::find_if(m_actionList.begin(),
-                                                                            m_actionList.end(),
-                                                                            bind(&compareDigest, _1, digest));
-  if (it != m_actionList.end()) {
+  if (m_actionLog.find(digest) != m_actionLog.end()) {
    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process recovery interest "<<name);
-    Msg message(SyncStateMsg::ACTION);
+    Msg message(SyncStateMsg::ACTION, m_encoding);
     SyncTree::const_iter iterator = m_syncTree.begin();
     while (iterator != m_syncTree.end()) {
       ActionEntry entry(iterator->first, iterator->second.last);
@@ -513,10 +670,36 @@ RepoSyncDelete::sendSnapshot(const Name& name)
 {
   //std::cout<<m_creatorName<<" send snapshot"<<std::endl;
   //NS_LOG_INFO ("***********************node("<< GetNode()->GetId() <<") send snapshot****************");
-  sendData(name, m_snapshot);
+  // the first segment tells the requester how many segments to fetch, or which deltas
+  // it may fetch instead
+  materializeSnapshot();
+  sendData(name, m_snapshot.front());
   //m_scheduler.schedule(ns3::MilliSeconds(m_senddataJitter()), bind(&RepoSyncDelete::sendData, this, name, m_snapshot), 100);
 }
 
+void
+RepoSyncDelete::processSnapshotInterest(const Name& name)
+{
+  // only the segments of the current snapshot and its deltas are served, the requester of an
+  // older one gives up after its retries and recovers
+  SnapshotFetcher::SnapshotId id;
+  uint64_t base, segment;
+  bool isDelta = parseSnapshotName(name, id, base, segment);
+  if (id.first != m_creatorName || id.second + 1 != m_snapshotNo)
+    return;
+  materializeSnapshot();
+  const std::vector<Msg>* segments = &m_snapshot;
+  if (isDelta) {
+    uint64_t firstBase = id.second - m_deltas.size();
+    if (base < firstBase || base >= id.second)
+      return;
+    segments = &m_deltas[base - firstBase];
+  }
+  if (segment >= segments->size())
+    return;
+  sendData(name, (*segments)[segment]);
+}
+
 void
 RepoSyncDelete::writeDataToSnapshot(Msg* msg, const Name& name, const status& stat)
 {
@@ -524,27 +707,48 @@ RepoSyncDelete::writeDataToSnapshot(Msg* msg, const Name& name, const status& st
   msg->writeDataToSnapshot(name, stat);
 }
 
+void
+RepoSyncDelete::writeDataToSegments(const std::map<Name, status>& data, std::vector<Msg>& segments, size_t first)
+{
+  for (std::map<Name, status>::const_iterator it = data.begin(); it != data.end(); it++) {
+    if (segments.size() <= first ||
+        (m_snapshotSegmentSize > 0 && segments.back().getDataSize() >= m_snapshotSegmentSize))
+      segments.push_back(Msg(SyncStateMsg::SNAPSHOT, m_encoding));
+    writeDataToSnapshot(&segments.back(), it->first, it->second);
+  }
+  if (segments.size() <= first)
+    segments.push_back(Msg(SyncStateMsg::SNAPSHOT, m_encoding));
+}
+
+void
+RepoSyncDelete::numberSnapshotSegments(std::vector<Msg>& segments)
+{
+  // the segments belong to the current snapshot, m_snapshotNo is the number of the next one
+  for (size_t i = 0; i < segments.size(); i++) {
+    segments[i].writeInfoToSnapshot(m_creatorName, m_snapshotNo - 1);
+    segments[i].writeSegmentToSnapshot(i, segments.size() - 1);
+  }
+}
+
 void
 RepoSyncDelete::sendSyncInterest()
 {
-  //std::cout<<m_creatorName<<"**************send sync interest**************  action size() =  "<<m_actionList.size()<<std::endl;
-  //std::cout<<m_creatorName<<"interest digest is "<<*m_syncTree.getDigest()<<std::endl;
+  //std::cout<<m_creatorName<<"**************send sync interest**************  action size() =  "<<m_actionLog.size()<<std::endl;
+  //std::cout<<m_creatorName<<"interest digest is "<<m_syncTree.getDigest()<<std::endl;
   
   m_outstandingInterestName = m_syncPrefix;
   std::ostringstream os;
-  os << *m_syncTree.getDigest();
+  os << m_syncTree.getDigest();
   
   m_outstandingInterestName.append("sync").append(os.str());
-  Ptr<Interest> interest = Create<Interest>();
-  interest->SetName(m_outstandingInterestName);
-  interest->SetInterestLifetime(m_interestLifetime);
-  ////NS_LOG_INFO ("node("<< GetNode()->GetId() <<") digest : " << *m_syncTree.getDigest());
+  ////NS_LOG_INFO ("node("<< GetNode()->GetId() <<") digest : " << m_syncTree.getDigest());
   //if (GetNode()->GetId() == 1)
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") interest name : " << interest->GetName()<<" action size = "<<m_actionList.size());
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") interest name : " << interest->GetName()<<" action size = "<<m_actionLog.size());
 
-  m_ccnxHandle->sendInterest (m_outstandingInterestName.toUri (),
+  m_ccnxHandle->sendInterest (m_outstandingInterestName,
                               bind (&RepoSyncDelete::onData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onSyncTimeout, this, _1));
+                              bind(&RepoSyncDelete::onSyncTimeout, this, _1),
+                              m_interestLifetime);
   m_scheduler.cancel(REEXPRESSING_INTEREST);
   m_scheduler.schedule(ns3::Seconds(syncInterestReexpress) + ns3::MilliSeconds(m_reexpressionJitter()),
                        bind (&RepoSyncDelete::sendSyncInterest, this),
@@ -553,37 +757,128 @@ RepoSyncDelete::sendSyncInterest()
 }
 
 void
-RepoSyncDelete::sendFetchInterest(const Name& creatorName, const uint64_t& seq)
-{
-  Name actionName = creatorName;
-  actionName.appendSeqNum(seq);
-  //std::cout<<m_creatorName<<"send fetch interest name = "<<actionName<<" number = "<<m_retryTable[actionName]<<std::endl;
-  // if the retry number of this fetch interest exceeds a certain value, stop fetching
-  if (m_retryTable[actionName] >= retrytimes) {
-    m_retryTable.erase(actionName);
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") cannot fetch action name = "<<creatorName<<" seq = "<<seq);
-    throw Error("Cannot fetch the aciton");
+RepoSyncDelete::sendFetchInterest(CreatorId creator, const uint64_t& from, const uint64_t& to)
+{
+  const Name& creatorName = CreatorTable::getInstance().getName(creator);
+  ActionKey actionKey(creator, from);
+  //std::cout<<m_creatorName<<"send fetch interest name = "<<actionName<<" number = "<<m_retryTable[actionKey]<<std::endl;
+  // if the retry number of this fetch interest exceeds a certain value, stop fetching and
+  // leave the missing actions to recovery
+  if (m_retryTable[actionKey] >= retrytimes) {
+    m_retryTable.erase(actionKey);
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") cannot fetch action name = "<<creatorName<<" seq = "<<from);
+    pipelineEntrySeq& node = getNodeSeq(creator);
+    if (node.sending > node.current)
+      node.sending = node.current;
+    m_scheduler.cancel(RECOVER_FETCH);
+    m_scheduler.schedule(ns3::Seconds(0), bind(&RepoSyncDelete::recoverFetch, this), RECOVER_FETCH);
+    return;
   }
  /* char *num = new char[3];
   bzero(num, 3);
   sprintf(num,"%d", seq);*/
 
   Name interestName = m_syncPrefix;
-  interestName.append("fetch").append(creatorName).appendSeqNum(seq);
-  Ptr<Interest> interest = Create<Interest>();
-  interest->SetName(interestName);
-  interest->SetInterestLifetime(m_interestLifetime);
+  if (from == to)
+    interestName.append("fetch").append(creatorName).appendSeqNum(from);
+  else
+    interestName.append("range").append(creatorName).appendSeqNum(from).appendSeqNum(to);
+  // the interest lives for the retransmission timeout of the face, backed off for every retry
+  // and bounded by the interest lifetime; only a first transmission measures the round trip
+  int retries = m_retryTable[actionKey];
+  Time lifetime = m_ccnxHandle->getRetransmissionTimeout(retries);
+  if (lifetime > m_interestLifetime)
+    lifetime = m_interestLifetime;
   //if (GetNode()->GetId() == 0 )
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") interest name : " << interest->GetName()<<" seq = "<<seq);
-  m_ccnxHandle->sendInterest (interestName.toUri (),
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") interest name : " << interest->GetName()<<" seq = "<<from);
+  m_ccnxHandle->sendInterest (interestName,
                               bind (&RepoSyncDelete::onData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onFetchTimeout, this, _1));
+                              bind(&RepoSyncDelete::onFetchTimeout, this, _1),
+                              lifetime, retries == 0);
+
+  m_retryTable[actionKey]++;
+}
+
+void
+RepoSyncDelete::parseFetchName(const Name& name, Name& creator, uint64_t& from, uint64_t& to) const
+{
+  // fetch interest: /prefix/fetch/<creator>/<seq>
+  // range interest: /prefix/range/<creator>/<from>/<to>
+  int seqCount = (name.get(m_syncPrefix.size()).toUri() == "range") ? 2 : 1;
+  Name actionName = name.getSubName(m_syncPrefix.size() + 1);
+  to = actionName.get(-1).toSeqNum();
+  from = actionName.get(-seqCount).toSeqNum();
+  creator = actionName.getSubName(0, actionName.size() - seqCount);
+}
 
-  m_retryTable[actionName]++;
+void
+RepoSyncDelete::fetchActions(CreatorId creator, uint64_t from, uint64_t to)
+{
+  uint64_t range = (m_fetchRange > 0 ? m_fetchRange : 1);
+  for (uint64_t first = from; first <= to; first += range) {
+    uint64_t last = (to - first < range ? to : first + range - 1);
+    sendFetchInterest(creator, first, last);
+  }
 }
 
 void
-RepoSyncDelete::onSyncTimeout(const std::string str)
+RepoSyncDelete::queueFetch(CreatorId creator, uint64_t from, uint64_t to)
+{
+  if (m_fetchDispatcher.push(creator, from, to))
+    m_scheduler.schedule(m_fetchTick, bind(&RepoSyncDelete::dispatchFetches, this), DISPATCH_FETCH);
+}
+
+void
+RepoSyncDelete::dispatchFetches()
+{
+  if (m_fetchDispatcher.dispatch(bind(&RepoSyncDelete::sendFetchInterest, this, _1, _2, _3)))
+    m_scheduler.schedule(m_fetchTick, bind(&RepoSyncDelete::dispatchFetches, this), DISPATCH_FETCH);
+}
+
+void
+RepoSyncDelete::fetchSnapshotSegments(const SnapshotFetcher::SnapshotId& id)
+{
+  uint64_t segment;
+  while (m_snapshotFetcher.nextSegment(id, segment))
+    sendSnapshotInterest(id, segment, 0);
+}
+
+void
+RepoSyncDelete::sendSnapshotInterest(const SnapshotFetcher::SnapshotId& id, uint64_t segment, int retries)
+{
+  Name interestName = m_syncPrefix;
+  uint64_t base;
+  if (m_snapshotFetcher.getDeltaBase(id, base))
+    interestName.append("delta").append(id.first).appendSeqNum(id.second).appendSeqNum(base).appendSeqNum(segment);
+  else
+    interestName.append("snapshot").append(id.first).appendSeqNum(id.second).appendSeqNum(segment);
+  // segments are retransmitted like fetch interests
+  Time lifetime = m_ccnxHandle->getRetransmissionTimeout(retries);
+  if (lifetime > m_interestLifetime)
+    lifetime = m_interestLifetime;
+  m_ccnxHandle->sendInterest (interestName,
+                              bind (&RepoSyncDelete::onData, this, _1, _2, _3),
+                              bind(&RepoSyncDelete::onSnapshotTimeout, this, _1),
+                              lifetime, retries == 0);
+}
+
+bool
+RepoSyncDelete::parseSnapshotName(const Name& name, SnapshotFetcher::SnapshotId& id, uint64_t& base, uint64_t& segment) const
+{
+  // snapshot interest: /prefix/snapshot/<creator>/<version>/<segment>
+  // delta interest:    /prefix/delta/<creator>/<version>/<base>/<segment>
+  bool isDelta = (name.get(m_syncPrefix.size()).toUri() == "delta");
+  int seqCount = isDelta ? 3 : 2;
+  Name snapshotName = name.getSubName(m_syncPrefix.size() + 1);
+  segment = snapshotName.get(-1).toSeqNum();
+  base = isDelta ? snapshotName.get(-2).toSeqNum() : 0;
+  id.second = snapshotName.get(-seqCount).toSeqNum();
+  id.first = snapshotName.getSubName(0, snapshotName.size() - seqCount);
+  return isDelta;
+}
+
+void
+RepoSyncDelete::onSyncTimeout(const Name &name)
 {
   //std::cerr << "Sync interest timeout"<<std::endl;
   // It is OK. Others will handle the time out situation.
@@ -592,39 +887,65 @@ RepoSyncDelete::onSyncTimeout(const std::string str)
 
 
 void
-RepoSyncDelete::onFetchTimeout(const std::string str)
+RepoSyncDelete::onFetchTimeout(const Name &name)
 {
   //std::cerr << "*********Fetch interest timeout***********" <<std::endl;
 
-  Name name(str);
-
-  Name actionName = name.getSubName(m_syncPrefix.size() + 1);
-  uint64_t seq = actionName.get(-1).toSeqNum();
-  Name creator = actionName.getSubName(0, actionName.size() - 1);
+  Name creator;
+  uint64_t from, to;
+  parseFetchName(name, creator, from, to);
   //if (GetNode()->GetId() == 11)
-    //NS_LOG_INFO ("!!!!!!!!!!!!!!!!!!!1node("<< GetNode()->GetId() <<") fetch interest timeout : " << str<<" count = "<<m_retryTable[actionName]);
-  sendFetchInterest(creator, seq);
+    //NS_LOG_INFO ("!!!!!!!!!!!!!!!!!!!1node("<< GetNode()->GetId() <<") fetch interest timeout : " << name<<" count = "<<m_retryTable[ActionKey(CreatorTable::getInstance().intern(creator), from)]);
+  CreatorId creatorId = CreatorTable::getInstance().intern(creator);
+  // a lost fetch shrinks the window of the creator
+  m_fetchWindow.onTimeout(creatorId, from, getNodeSeq(creatorId).sending);
+  sendFetchInterest(creatorId, from, to);
 }
 
 void
-RepoSyncDelete::onRecoveryTimeout(const std::string str)
+RepoSyncDelete::onRecoveryTimeout(const Name &name)
 {
   //std::cerr << "+++++++++++++++++++Recovery interest timeout+++++++++++++" <<std::endl;
-  //NS_LOG_INFO ("+++++++++++++++++++node("<< GetNode()->GetId() <<") fetch interest timeout : " << str);
+  //NS_LOG_INFO ("+++++++++++++++++++node("<< GetNode()->GetId() <<") fetch interest timeout : " << name);
+}
+
+void
+RepoSyncDelete::onSnapshotTimeout(const Name &name)
+{
+  SnapshotFetcher::SnapshotId id;
+  uint64_t base, segment, fetchingBase;
+  bool isDelta = parseSnapshotName(name, id, base, segment);
+  // ignore the segments of what is no longer fetched for the snapshot
+  if (isDelta != m_snapshotFetcher.getDeltaBase(id, fetchingBase) || (isDelta && base != fetchingBase))
+    return;
+  int timeouts = m_snapshotFetcher.onTimeout(id, segment);
+  if (timeouts == 0)
+    return;
+  // the snapshot is likely replaced by a newer one, forget it so that it can be fetched
+  // again and leave the missing data to recovery
+  if (timeouts >= retrytimes) {
+    NS_LOG_INFO ("node("<< GetNode()->GetId() <<") cannot fetch snapshot "<<id.first<<" version = "<<id.second);
+    m_snapshotFetcher.abort(id);
+    m_snapshotList.remove(id);
+    m_scheduler.cancel(RECOVER_FETCH);
+    m_scheduler.schedule(ns3::Seconds(0), bind(&RepoSyncDelete::recoverFetch, this), RECOVER_FETCH);
+    return;
+  }
+  sendSnapshotInterest(id, segment, timeouts);
 }
 
 void
-RepoSyncDelete::setFilterTimeout(const std::string str)
+RepoSyncDelete::setFilterTimeout(const Name &name)
 {
   std::cerr << "-----------------register interest timeout---------------" <<std::endl;
 }
 
 void
-RepoSyncDelete::sendRecoveryInterest(DigestConstPtr digest)
+RepoSyncDelete::sendRecoveryInterest(const DigestValue& digest)
 {
   //std::cout<<"send recovery interest"<<std::endl;
   std::ostringstream os;
-  os << *digest;
+  os << digest;
 
   Name interestName = m_syncPrefix;
   interestName.append("recovery").append(os.str());
@@ -636,14 +957,21 @@ RepoSyncDelete::sendRecoveryInterest(DigestConstPtr digest)
     m_scheduler.schedule(ns3::MilliSeconds(m_recoveryRetransmissionInterval + m_reexpressionJitter()),
                               bind(&RepoSyncDelete::sendRecoveryInterest, this, digest), REEXPRESSING_RECOVERY_INTEREST);
 
-  Ptr<Interest> interest= Create<Interest>();
-  interest->SetName(interestName);
-  interest->SetInterestLifetime(m_interestLifetime);
   //if (GetNode()->GetId() > 33 || GetNode()->GetId() == 1)
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") !!!!!!!!!!!!!!!!!!send recovery interest name : " << interest->GetName());
-  m_ccnxHandle->sendInterest (interestName.toUri (),
+  m_ccnxHandle->sendInterest (interestName,
                               bind(&RepoSyncDelete::onData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onRecoveryTimeout, this, _1));
+                              bind(&RepoSyncDelete::onRecoveryTimeout, this, _1),
+                              m_interestLifetime);
+}
+
+void
+RepoSyncDelete::recoverFetch()
+{
+  // restart the recovery from the current state, peers that know the digest reply with
+  // the last actions of all the creators and the missing actions are fetched again
+  m_recoveryRetransmissionInterval = defaultRecoveryRetransmitInterval;
+  sendRecoveryInterest(m_syncTree.getDigest());
 }
 
 void
@@ -662,43 +990,19 @@ RepoSyncDelete::checkInterestSatisfied(const Name &name)
 }
 
 void
-RepoSyncDelete::sendData(const Name &name, Msg& ssm)
+RepoSyncDelete::sendData(const Name &name, const Msg& ssm)
 {
-  
-  int size = ssm.getMsg().ByteSize();
-  char *wireData = new char[size];
-  ssm.getMsg().SerializeToArray(wireData, size);
-
-  Ptr<ndn::Data> data = Create<ndn::Data> (Create<Packet> (reinterpret_cast<const uint8_t*> (wireData), size));
-  data->SetName(name);
-  data->SetFreshness(ns3::Seconds(syncResponseFreshness));
-
-  m_ccnxHandle->publishRawData (name.toUri(), wireData, size, 100); 
+  // the encoding is cached in the message, a snapshot sent to many repos is only encoded once
+  const std::string& wire = ssm.getWire();
+  m_ccnxHandle->publishRawData (name.toUri(), wire.data(), wire.size(), 100); 
   //if (GetNode()->GetId() == 0)
-  //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") data name : " << name<<" size = "<<size);
-  /*
-  ostringstream content;
-  data->GetPayload()->CopyData(&content, data->GetPayload()->GetSize ());
-
-  const char* wireData_test = content.str().c_str();
-  size_t len = content.str().size();
-  SyncStateMsg msg;
-  std::cout<<"send data content "<<content.str()<<std::endl;
-  if (!msg.ParseFromArray(wireData_test, len) || !msg.IsInitialized())
-  {
-    std::cout<<"!!!!!!!!!!!test size in send data "<<len<<std::endl;
-    std::cout<<wireData_test<<std::endl;
-    //Throw
-    BOOST_THROW_EXCEPTION(Digest::SyncStateMsgDecodingFailure());
-  }*/
-  delete []wireData;
+  //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") data name : " << name<<" size = "<<wire.size());
 }
 
 
 void
-RepoSyncDelete::onData(const std::string &str, const char *wireData, size_t len)
+RepoSyncDelete::onData(const Name &name, const char *wireData, size_t len)
 {
-  Name name(str);
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<")  received data : " << name);
 
   try
@@ -706,17 +1010,21 @@ RepoSyncDelete::onData(const std::string &str, const char *wireData, size_t len)
       std::string type = name[m_syncPrefix.size()].toUri();
       if (type == "sync")
         {
-          DigestConstPtr digest = convertNameToDigest(name);
+          DigestValue digest = convertNameToDigest(name);
           m_syncInterestTable.remove(name.toUri());
           processSyncData(name, wireData, len);
         }
-      else if (type == "fetch")
+      else if (type == "fetch" || type == "range")
         {
           processFetchData(name, wireData, len);
         }
+      else if (type == "snapshot" || type == "delta")
+        {
+          processSnapshotData(name, wireData, len);
+        }
       else if (type == "recovery")
         {
-          DigestConstPtr digest = convertNameToDigest(name);
+          DigestValue digest = convertNameToDigest(name);
           // timer is always restarted when we schedule recovery
           m_syncInterestTable.remove(name.toUri());
           m_scheduler.cancel(REEXPRESSING_RECOVERY_INTEREST);
@@ -737,15 +1045,16 @@ RepoSyncDelete::processSyncData(const Name& name, const char* wireData, size_t l
   bool ownInterestSatisfied = false;
   ownInterestSatisfied = (name == m_outstandingInterestName);
   
-  SyncStateMsg msg;
+  MsgPool::Lease lease(m_msgPool);
+  Msg& message = *lease;
   //std::cout<<"process sync data = "<<name<<std::endl;
-  if (!msg.ParseFromArray(wireData, len) || !msg.IsInitialized())
+  if (!message.parseFrom(wireData, len))
   {
     //Throw
-    BOOST_THROW_EXCEPTION(Digest::SyncStateMsgDecodingFailure());
+    BOOST_THROW_EXCEPTION(ns3::ndn::Error::SyncStateMsgDecodingFailure());
   }
-  Msg message(msg);
   if (message.getMsg().type() == SyncStateMsg::ACTION) {
+    message.readEmbeddedActionFromMsg(bind(&RepoSyncDelete::onEmbeddedAction, this, _1), m_creatorName);
     message.readActionNameFromMsg(bind(&RepoSyncDelete::prepareFetchForSync, this, _1, _2, _3), m_creatorName);
   }
   else {
@@ -766,19 +1075,25 @@ RepoSyncDelete::processFetchData(const Name& name, const char* wireData, size_t
 {
   //if (GetNode()->GetId() == 11)
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process fetch data "<<name);
-  SyncStateMsg msg;
-  if (!msg.ParseFromArray(wireData, len) || !msg.IsInitialized())
+  MsgPool::Lease lease(m_msgPool);
+  Msg& message = *lease;
+  if (!message.parseFrom(wireData, len))
   {
-    BOOST_THROW_EXCEPTION(Digest::SyncStateMsgDecodingFailure() );
+    BOOST_THROW_EXCEPTION(ns3::ndn::Error::SyncStateMsgDecodingFailure() );
   }
-  Msg message(msg);
   if (message.getMsg().type() == SyncStateMsg::ACTION) {
     // process action
     Name final = name.getSubName(0, name.size() - 1);
     final.appendSeqNum(50);
     //if (name == final)
       //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process ACTION "<<name);
-    message.readActionFromMsg(bind(&RepoSyncDelete::actionControl, this, _1));
+    Name creator;
+    uint64_t from, to;
+    parseFetchName(name, creator, from, to);
+    size_t count = message.readActionFromMsg(bind(&RepoSyncDelete::actionControl, this, _1));
+    // the responder only had the beginning of the range, queue the rest
+    if (count > 0 && count <= to - from)
+      queueFetch(CreatorTable::getInstance().intern(creator), from + count, to);
   }
   else if (message.getMsg().type() == SyncStateMsg::SNAPSHOT) {
     // process snapshot
@@ -788,9 +1103,9 @@ RepoSyncDelete::processFetchData(const Name& name, const char* wireData, size_t
     std::list<std::pair<Name, uint64_t> >::iterator it =
                                         std::find_if(m_snapshotList.begin(), m_snapshotList.end(),
                                                      bind(&compareSnapshot, _1, info));
-    // if snapshot has been fetched once, ignore it
+    // if snapshot has been fetched once or is being fetched, ignore it
     // Otherwise, process the snapshot and record it info
-    if (it != m_snapshotList.end()) {
+    if (it != m_snapshotList.end() || m_snapshotFetcher.isFetching(info)) {
       return;
     }
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process SNAPSHOT "<<info.first);
@@ -799,7 +1114,20 @@ RepoSyncDelete::processFetchData(const Name& name, const char* wireData, size_t
                          bind(&RepoSyncDelete::removeSnapshotEntry, this, m_snapshotList.back()), REMOVE_SNAPSHOT);
 
     message.readDataFromSnapshot(bind(&RepoSyncDelete::processSnapshot, this, _1, _2));
-    message.readTreeFromSnapshot(bind(&RepoSyncDelete::updateSyncTree, this, _1));
+    // this is the first segment, the others are fetched before the sync tree is updated
+    uint64_t finalSegment = message.readSegmentFromSnapshot().second;
+    if (finalSegment == 0) {
+      applySnapshotTree(message);
+      return;
+    }
+    // a repo that applied an earlier snapshot of the same repo only fetches the changes since
+    std::map<Name, uint64_t>::iterator applied = m_appliedSnapshots.find(info.first);
+    uint64_t deltaSegment;
+    if (applied != m_appliedSnapshots.end() && message.readDeltaFromSnapshot(applied->second, deltaSegment))
+      m_snapshotFetcher.startDelta(info, applied->second, deltaSegment, message);
+    else
+      m_snapshotFetcher.start(info, finalSegment, message);
+    fetchSnapshotSegments(info);
   }
   else {
     throw Error("The response of fetch interest should not in this type!");
@@ -813,106 +1141,166 @@ RepoSyncDelete::processRecoveryData(const Name& name, const char* wireData, size
    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") !!!!!!!!!!!!!!!!process recovery data "<<name);
   m_syncInterestTable.remove(name.toUri());
   //Msg message(SyncStateMsg::ACTION);
-  SyncStateMsg msg;// = message.getMsg();
-  if (!msg.ParseFromArray(wireData, len) || !msg.IsInitialized())
+  MsgPool::Lease lease(m_msgPool);
+  Msg& message = *lease;
+  if (!message.parseFrom(wireData, len))
   {
     //Throw
-    BOOST_THROW_EXCEPTION(Digest::SyncStateMsgDecodingFailure() );
+    BOOST_THROW_EXCEPTION(ns3::ndn::Error::SyncStateMsgDecodingFailure() );
   }
-  Msg message(msg);
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") READ recovery data !!!!!!");
   message.readActionNameFromMsg(bind(&RepoSyncDelete::prepareFetchForRecovery, this, _1, _2, _3), m_creatorName);
 }
 
 void
-RepoSyncDelete::prepareFetchForSync(const Name& name, const uint64_t seq, const uint64_t finalSeq)
+RepoSyncDelete::processSnapshotData(const Name& name, const char* wireData, size_t len)
 {
-  // this function is called when the sync interest digest is outdated
+  MsgPool::Lease lease(m_msgPool);
+  Msg& message = *lease;
+  if (!message.parseFrom(wireData, len))
+  {
+    BOOST_THROW_EXCEPTION(ns3::ndn::Error::SyncStateMsgDecodingFailure() );
+  }
+  if (message.getMsg().type() != SyncStateMsg::SNAPSHOT) {
+    throw Error("The response of snapshot interest should not in this type!");
+  }
+  SnapshotFetcher::SnapshotId id;
+  uint64_t base, segment, fetchingBase;
+  bool isDelta = parseSnapshotName(name, id, base, segment);
+  if (isDelta != m_snapshotFetcher.getDeltaBase(id, fetchingBase) || (isDelta && base != fetchingBase))
+    return;
+  if (!m_snapshotFetcher.onSegment(id, segment))
+    return;
+  // every segment is applied as it arrives, the sync tree once all of them are there
+  message.readDataFromSnapshot(bind(&RepoSyncDelete::processSnapshot, this, _1, _2));
+  Msg head(SyncStateMsg::SNAPSHOT);
+  if (m_snapshotFetcher.finish(id, head))
+    applySnapshotTree(head);
+  else
+    fetchSnapshotSegments(id);
+}
+
+void
+RepoSyncDelete::applySnapshotTree(Msg& message)
+{
+  // the next snapshot of the same repo can be fetched as a delta
+  std::pair<Name, uint64_t> info = message.readInfoFromSnapshot();
+  m_appliedSnapshots[info.first] = info.second;
+  message.readTreeFromSnapshot(bind(&RepoSyncDelete::updateSyncTree, this, _1));
+}
+
+void
+RepoSyncDelete::prepareFetchForSync(CreatorId creator, const uint64_t first, const uint64_t last)
+{
+  // this function is called when the sync interest digest is outdated, once for every
+  // creator in the reply with the range of its actions the reply announced; the actions
+  // up to 'last' are fetched, 'first' only tells where the announced range starts
   // m_nodeSeq record the information of sequence number for each node
   // 'current' represents the last seq number the repo has
   // 'sending' represents the action seq number that is on fetching
   // 'final'   represents the last seq number that should be fetched
   //if (GetNode()->GetId() ==1 )
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") prepare for fetch seq "<<seq);
-  SyncTree::const_iter iterator = m_syncTree.lookup(name);
-  m_nodeSeq[name].final = finalSeq;
-  uint64_t& sending = m_nodeSeq[name].sending;
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") prepare for fetch seq "<<last);
+  SyncTree::const_iter iterator = m_syncTree.lookup(creator);
+  pipelineEntrySeq& node = getNodeSeq(creator);
+  uint64_t window = m_fetchWindow.get(creator);
+  node.final = last;
+  uint64_t& sending = node.sending;
   if (iterator != m_syncTree.end())
   {
-    m_nodeSeq[name].current = iterator->second.last;
-    if (iterator->second.last >= seq || sending >= seq) {
+    node.current = iterator->second.last;
+    if (iterator->second.last >= last || sending >= last) {
       //std::cerr << "Action has been fetched or sent" << std::endl;
-      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") Action has been fetched "<<name<<" seq = "<<seq);
+      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") Action has been fetched "<<name<<" seq = "<<last);
       return;
     }
-    if (sending == m_nodeSeq[name].current) {
-       uint64_t lastSendSeq = (iterator->second.last+pipeline < seq ? iterator->second.last+pipeline : seq);
-      for (uint64_t seqno = iterator->second.last + 1; seqno <= lastSendSeq; seqno++) {
-          sendFetchInterest(name, seqno);
-      }
+    if (sending == node.current) {
+       uint64_t lastSendSeq = (iterator->second.last+window < last ? iterator->second.last+window : last);
+      fetchActions(creator, iterator->second.last + 1, lastSendSeq);
       sending = lastSendSeq;
     }
   }
   else
   {
-    m_nodeSeq[name].current = 0;
-    m_syncTree.addNode(name);
-    uint64_t lastSendSeq = (pipeline < finalSeq ? pipeline : finalSeq);
-    for (uint64_t seqno = 1; seqno <= lastSendSeq; seqno++) {
-      sendFetchInterest(name, seqno);
-    }
+    node.current = 0;
+    m_syncTree.addNode(CreatorTable::getInstance().getName(creator));
+    uint64_t lastSendSeq = (window < last ? window : last);
+    fetchActions(creator, 1, lastSendSeq);
     sending = lastSendSeq;
   }
 }
 
 void
-RepoSyncDelete::prepareFetchForRecovery(const Name& name, const uint64_t seq, const uint64_t finalSeq)
+RepoSyncDelete::onEmbeddedAction(const ActionEntry& action)
+{
+  // the action is handled as if it had been fetched, the ones before it that are still
+  // missing are fetched by the action control
+  CreatorId creator = action.getCreatorId();
+  SyncTree::const_iter iterator = m_syncTree.lookup(creator);
+  pipelineEntrySeq& node = getNodeSeq(creator);
+  if (iterator != m_syncTree.end()) {
+    node.current = iterator->second.last;
+  }
+  else {
+    node.current = 0;
+    m_syncTree.addNode(action.getCreatorName());
+  }
+  if (action.getSeqNo() <= node.current)
+    return;
+  if (node.final < action.getSeqNo())
+    node.final = action.getSeqNo();
+  if (node.sending < action.getSeqNo())
+    node.sending = action.getSeqNo();
+  actionControl(action);
+}
+
+void
+RepoSyncDelete::prepareFetchForRecovery(CreatorId creator, const uint64_t first, const uint64_t last)
 {
   //if (GetNode()->GetId() > 33)
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") prepare for recoevery "<<name<<" seq = "<<seq);
-  // this function is called when the sync interest digest is unrecognized
-  SyncTree::const_iter iterator = m_syncTree.lookup(name);
-  m_nodeSeq[name].final = finalSeq;
-  //std::cout<<"prepare fetch for recovery name ="<<name<<" seq = "<<m_nodeSeq[name].final<<std::endl;
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") prepare for recoevery "<<name<<" seq = "<<last);
+  // this function is called when the sync interest digest is unrecognized, once for every
+  // creator in the reply with the last action of the creator
+  SyncTree::const_iter iterator = m_syncTree.lookup(creator);
+  pipelineEntrySeq& node = getNodeSeq(creator);
+  uint64_t window = m_fetchWindow.get(creator);
+  node.final = last;
+  //std::cout<<"prepare fetch for recovery name ="<<name<<" seq = "<<node.final<<std::endl;
   if (iterator != m_syncTree.end())
   {
-    m_nodeSeq[name].current = iterator->second.last;
-    if (iterator->second.last >= seq) {
+    node.current = iterator->second.last;
+    if (iterator->second.last >= last) {
       //std::cerr << "Action has been fetched" << std::endl;
-      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") Action has been fetched "<<name<<" seq = "<<seq);
+      //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") Action has been fetched "<<name<<" seq = "<<last);
       return;
     }
-    if (m_nodeSeq[name].sending <= m_nodeSeq[name].current) {
-      uint64_t lastSendSeq = (iterator->second.last+pipeline < finalSeq ? iterator->second.last+pipeline : finalSeq);
-      for (uint64_t seqno = iterator->second.last + 1; seqno <= lastSendSeq; seqno++) {
-        sendFetchInterest(name, seqno);
-      }
-      m_nodeSeq[name].sending = lastSendSeq;
+    if (node.sending <= node.current) {
+      uint64_t lastSendSeq = (iterator->second.last+window < last ? iterator->second.last+window : last);
+      fetchActions(creator, iterator->second.last + 1, lastSendSeq);
+      node.sending = lastSendSeq;
     }
     else {
-      std::list<ActionEntry>& pendingList = m_pendingActionList[name];
-      if (!pendingList.empty())
+      ReorderBuffer& buffer = getReorderBuffer(creator);
+      buffer.advance(node.current);
+      if (!buffer.empty())
       { 
-        uint64_t pending = pendingList.begin()->getSeqNo();
-        for (uint64_t seqno = m_nodeSeq[name].current + 1; seqno < pending; ++seqno)
+        uint64_t pending = buffer.first();
+        for (uint64_t seqno = node.current + 1; seqno < pending; ++seqno)
         {
-          Name creator = name;
-          m_retryTable.erase(creator.appendSeqNum(seqno));
-          sendFetchInterest(name, seqno);
+          m_retryTable.erase(ActionKey(creator, seqno));
         }
+        fetchActions(creator, node.current + 1, pending - 1);
       }
     }
     
   }
   else
   {
-    m_nodeSeq[name].current = 0;
-    m_syncTree.addNode(name);
-    uint64_t lastSendSeq = (pipeline < seq ? pipeline : seq);
-    for (uint64_t seqno = 1; seqno <= lastSendSeq; seqno++) {
-      sendFetchInterest(name, seqno);
-    }
-    m_nodeSeq[name].sending = lastSendSeq;
+    node.current = 0;
+    m_syncTree.addNode(CreatorTable::getInstance().getName(creator));
+    uint64_t lastSendSeq = (window < last ? window : last);
+    fetchActions(creator, 1, lastSendSeq);
+    node.sending = lastSendSeq;
   }
 
 }
@@ -921,12 +1309,12 @@ void
 RepoSyncDelete::processSnapshot(const Name& name, const status& dataStatus)
 {
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") process snapshot ");
-  std::map<Name, status>::iterator it = m_storageHandle.find(name);
+  DataIndex::const_iterator it = m_storageHandle.find(name);
   status stat;
   if (it == m_storageHandle.end())
     stat = NONE;
   else
-    stat = m_storageHandle[name];
+    stat = it->second;
 
   if (dataStatus == EXISTED) {
     if (stat == NONE) {  //if data is deleted, do not insert this data back
@@ -938,7 +1326,7 @@ RepoSyncDelete::processSnapshot(const Name& name, const status& dataStatus)
     // so do not deleted the data.
     //we assume same data will not be deleted and inserted multiple times
     if (stat == EXISTED) {
-      m_storageHandle[name] = DELETED;
+      m_storageHandle.setStatus(it, DELETED);
     }
   }
   else {
@@ -953,26 +1341,25 @@ void
 RepoSyncDelete::sendNormalInterest(const Name& name)
 {
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") send normal interest : "<<name);
-  Ptr<Interest> fetchInterest = Create<Interest>();
-  fetchInterest->SetName(name);
-  fetchInterest->SetInterestLifetime(m_interestLifetime);
 
-   m_ccnxHandle->sendInterest (name.toUri(),
+   m_ccnxHandle->sendInterest (name,
                               bind (&RepoSyncDelete::onFetchData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onDataTimeout, this, _1));
+                              bind(&RepoSyncDelete::onDataTimeout, this, _1),
+                              m_interestLifetime);
 }
 
 void
 RepoSyncDelete::actionControl(const ActionEntry& action)
 {
-  // use pipeline to control received action
-  // if receives an action, send the action with seq number = min( received seq + pipeline, final )
+  // use the fetch window of the creator to control received action
+  // if receives an action, send the action with seq number = min( received seq + window, final )
   // if received action is in ordered, apply the action
-  // Otherwise, save it in the pending table and retransmit all the missing actions
-  m_reTransmit.erase(action.getName());
-  uint64_t& currentSeq = m_nodeSeq[action.getCreatorName()].current;
-  uint64_t& lastSeq = m_nodeSeq[action.getCreatorName()].final;
-  uint64_t& sending = m_nodeSeq[action.getCreatorName()].sending;
+  // Otherwise, save it in the reorder buffer and retransmit the missing actions before it
+  CreatorId creator = action.getCreatorId();
+  pipelineEntrySeq& node = getNodeSeq(creator);
+  uint64_t& currentSeq = node.current;
+  uint64_t& lastSeq = node.final;
+  uint64_t& sending = node.sending;
   //if (GetNode()->GetId() == 11)
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") ACTION CONTROL "<<action.getSeqNo()<<" current = "<<currentSeq<< " lastSeq = "<<lastSeq<<" sending = "<<sending);
   if (action.getSeqNo() > lastSeq) {
@@ -981,63 +1368,48 @@ RepoSyncDelete::actionControl(const ActionEntry& action)
     //return;
     lastSeq = action.getSeqNo();
   }
-  Name name = action.getCreatorName();
-  std::list<ActionEntry>& pendingList = m_pendingActionList[name];
-  m_retryTable.erase(action.getName());
+  ReorderBuffer& buffer = getReorderBuffer(creator);
+  m_retryTable.erase(ActionKey(creator, action.getSeqNo()));
   if (currentSeq + 1 == action.getSeqNo()) {
+    // only a new action opens the window, not a duplicate or an already applied one
+    m_fetchWindow.onAction(creator);
     currentSeq++;
     applyAction(action);
    
-    while (!pendingList.empty() && pendingList.front().getSeqNo() == currentSeq + 1) {
+    buffer.advance(currentSeq);
+    while (buffer.hasNext()) {
       currentSeq++;
-      applyAction(pendingList.front());
-      pendingList.pop_front();
+      applyAction(buffer.next());
+      buffer.popNext();
     }
      
-    uint64_t seqno;
-    if (currentSeq >= sending)
-    {
-      for (seqno = currentSeq + 1; seqno <= (currentSeq + pipeline <= lastSeq ? currentSeq + pipeline : lastSeq); seqno++) {  
-        m_scheduler.schedule(ns3::MilliSeconds(0.01), bind(&RepoSyncDelete::sendFetchInterest, this, name, seqno), 101);
-      }
-      sending = seqno - 1;
-    }
-    else
-    {
-      uint64_t step = currentSeq - action.getSeqNo();
-      for (seqno = sending + 1; seqno <= (sending + 1 + step <= lastSeq ? sending + 1 + step : lastSeq); seqno++) {
-        m_scheduler.schedule(ns3::MilliSeconds(0.01), bind(&RepoSyncDelete::sendFetchInterest, this, name, seqno), 101);
-      }
-      sending = seqno - 1;
+    // keep a window of actions on the way, the window is refilled with full ranges
+    // unless the refill reaches the last action
+    uint64_t window = m_fetchWindow.get(creator);
+    uint64_t windowEnd = (currentSeq + window <= lastSeq ? currentSeq + window : lastSeq);
+    if (sending < currentSeq)
+      sending = currentSeq;
+    if (windowEnd >= sending + m_fetchRange || (windowEnd == lastSeq && windowEnd > sending)) {
+      queueFetch(creator, sending + 1, windowEnd);
+      sending = windowEnd;
     }
     //if (GetNode()->GetId() == 11)
       //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") !!!!after "<<action.getSeqNo()<<" current = "<<currentSeq<< " lastSeq = "<<lastSeq<<" sending = "<<sending);
   }
   else if (currentSeq + 1 < action.getSeqNo()) {
-    // retransmit
-    std::list<ActionEntry>::iterator it = std::find_if(pendingList.begin(), pendingList.end(),
-                                                                            bind(&compareSeq, _1, action.getSeqNo()));
-    if (it != pendingList.end())
+    // buffer the action, a duplicate is dropped
+    buffer.advance(currentSeq);
+    if (!buffer.insert(action))
       return;
-    pendingList.push_back(action);
-    pendingList.sort();
-    
-    for (uint64_t seqno = currentSeq + 1; seqno < pendingList.begin()->getSeqNo(); ++seqno) {  // to be cchanged
-      Name entry = action.getCreatorName();
-      entry.appendSeqNum(seqno);
-      if (m_reTransmit[entry] == 0) {
-        m_reTransmit[entry]++;
-        m_scheduler.schedule(ns3::MilliSeconds(0.01), bind(&RepoSyncDelete::sendFetchInterest, this, action.getCreatorName(), seqno), 101);
-        //sendFetchInterest(action.getCreatorName(), seqno);
-        //if (GetNode()->GetId() == 11) 
-          //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") retransmit seq = "<<seqno);
-        
-      }
-      //
-
-    }
-    if (sending < pendingList.front().getSeqNo() - 1)
-      sending = pendingList.front().getSeqNo() - 1;
+    m_fetchWindow.onAction(creator);
+
+    // retransmit the missing actions before the first buffered one, each gap is only taken
+    // once and fetched as a range
+    std::pair<uint64_t, uint64_t> gap = buffer.takeGap();
+    if (gap.first <= gap.second)
+      queueFetch(creator, gap.first, gap.second);
+    if (sending < buffer.first() - 1)
+      sending = buffer.first() - 1;
   }
   else {
     // do nothing
@@ -1050,21 +1422,19 @@ RepoSyncDelete::applyAction(const ActionEntry& action)
   m_syncTree.update(action);
   // std::cout<<"update applyaction digest is = "<<m_syncTree.getDigest()<<std::endl;;
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") Apply action   !!!! ");
-  m_actionList.push_back(std::make_pair(m_syncTree.getDigest(), action));
+  logAction(action);
   if (action.getAction() == INSERTION) {
-    Ptr<Interest> fetchInterest = Create<Interest>();
-    fetchInterest->SetName(action.getDataName());
-    fetchInterest->SetInterestLifetime(m_interestLifetime);
     //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") send normal interest : "<<action.getDataName());
 
-      m_ccnxHandle->sendInterest (action.getDataName().toUri (),
+      m_ccnxHandle->sendInterest (action.getDataName(),
                               bind (&RepoSyncDelete::onFetchData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onDataTimeout, this, _1));
+                              bind(&RepoSyncDelete::onDataTimeout, this, _1),
+                              m_interestLifetime);
   }
   else if (action.getAction() == DELETION) {
-    std::map<Name, status>::iterator it = m_storageHandle.find(action.getDataName());
+    DataIndex::const_iterator it = m_storageHandle.find(action.getDataName());
     if (it != m_storageHandle.end())
-      m_storageHandle[action.getDataName()] = DELETED;
+      m_storageHandle.setStatus(it, DELETED);
   }
   else {
     throw Error("Cannot apply this action type !");
@@ -1072,31 +1442,29 @@ RepoSyncDelete::applyAction(const ActionEntry& action)
 }
 
 void
-RepoSyncDelete::onFetchData(const std::string &str, const char *wireData, size_t len)
+RepoSyncDelete::onFetchData(const Name &name, const char *wireData, size_t len)
 {
-  Name name(str);
   //Name final("data");
   //final.appendSeqNum(199);
   /*if (GetNode()->GetId() == 1)
     NS_LOG_INFO ("node("<< GetNode()->GetId() <<") receive normal data : "<<name<<"  stander data "<<final);
   if (name == final)
     NS_LOG_INFO ("node("<< GetNode()->GetId() <<") receive normal data : "<< name);*/
-  std::map<Name, status>::iterator it = m_storageHandle.find(name);
-  if (it == m_storageHandle.end())
-    m_storageHandle[name] = EXISTED;
-  else if (m_storageHandle[name] == DELETED) 
-    m_storageHandle[name] = INSERTED;
+  std::pair<DataIndex::const_iterator, bool> inserted = m_storageHandle.insert(name, EXISTED);
+  if (!inserted.second && inserted.first->second == DELETED)
+    m_storageHandle.setStatus(inserted.first, INSERTED);
 }
 
 void
-RepoSyncDelete::onDataTimeout(const std::string str)
+RepoSyncDelete::onDataTimeout(const Name &name)
 {
   //std::cerr << "Fetch data timeout !" << std::endl;
   //if (GetNode()->GetId() == 11)
-    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") data timeout : "<< str);
-  m_ccnxHandle->sendInterest (str,
+    //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") data timeout : "<< name);
+  m_ccnxHandle->sendInterest (name,
                               bind (&RepoSyncDelete::onFetchData, this, _1, _2, _3),
-                              bind(&RepoSyncDelete::onDataTimeout, this, _1));
+                              bind(&RepoSyncDelete::onDataTimeout, this, _1),
+                              m_interestLifetime);
 }
 
 void
@@ -1115,7 +1483,7 @@ RepoSyncDelete::removeActions()
 {
   init();
   m_retryTable.clear();
-  m_pendingActionList.clear();
+  m_reorderBuffers.clear();
   //NS_LOG_INFO ("node("<< GetNode()->GetId() <<") CREATE SNAPSHOT!!!! ");
   createSnapshot();
 }
@@ -1125,28 +1493,82 @@ RepoSyncDelete::createSnapshot()
 {
   //std::cout<<m_creatorName<<" createSnapshot seq = "<<m_snapshotNo<<""<<std::endl;
   
-  Msg message(SyncStateMsg::SNAPSHOT);
-  for (std::map<Name, status>::iterator it = m_storageHandle.begin(); it != m_storageHandle.end(); it++)
-    writeDataToSnapshot(&message, it->first, it->second);
+  // only the epoch of the index is kept, most snapshots are never requested, and their data
+  // and deltas are never built
+  m_snapshotData = m_storageHandle.freeze();
+  m_snapshotTree.clear();
   for (SyncTree::const_iter iter = m_syncTree.begin(); iter != m_syncTree.end(); iter++) {
-    message.writeTreeToSnapshot(iter->first, iter->second.last);
+    m_snapshotTree.push_back(std::make_pair(iter->first, iter->second.last));
   }
-  message.writeInfoToSnapshot(m_creatorName, m_snapshotNo);
-  m_snapshot.setMsg(message.getMsg());
+  m_snapshot.clear();
+  m_deltas.clear();
+  m_deltaChain.append(m_snapshotNo, m_snapshotData);
   m_snapshotNo++;
-  m_syncTree.updateForSnapshot();
+}
+
+void
+RepoSyncDelete::materializeSnapshot()
+{
+  if (!m_snapshot.empty())
+    return;
+  // segment 0 carries the sync tree and announces the deltas, the data follows in segments;
+  // a snapshot that fits in one segment is sent in one piece
+  std::vector<Msg> segments(1, Msg(SyncStateMsg::SNAPSHOT, m_encoding));
+  DataIndex::Map data;
+  m_snapshotData->getData(data);
+  writeDataToSegments(data, segments, 1);
+  if (segments.size() == 2) {
+    segments.front().swap(segments.back());
+    segments.pop_back();
+  }
+  for (size_t i = 0; i < m_snapshotTree.size(); i++) {
+    segments.front().writeTreeToSnapshot(m_snapshotTree[i].first, m_snapshotTree[i].second);
+  }
+  // a repo that applied one of the last snapshots only fetches the changes since, which is
+  // worth it once the snapshot takes several segments
+  if (segments.size() > 1) {
+    uint64_t version = m_snapshotNo - 1;
+    uint64_t firstBase = m_deltaChain.getFirstBase();
+    m_deltas.resize(version - firstBase);
+    DeltaChain::Changes changes;
+    for (uint64_t base = firstBase; base < version; base++) {
+      std::vector<Msg>& delta = m_deltas[base - firstBase];
+      m_deltaChain.getChanges(base, changes);
+      writeDataToSegments(changes, delta, 0);
+      numberSnapshotSegments(delta);
+      segments.front().writeDeltaToSnapshot(base, delta.size() - 1);
+    }
+  }
+  numberSnapshotSegments(segments);
+  m_snapshot.swap(segments);
 }
 
 void
 RepoSyncDelete::updateSyncTree(const ActionEntry& entry)
 {
   m_syncTree.update(entry);
-  pipelineEntrySeq &node = m_nodeSeq[entry.getCreatorName()];
+  pipelineEntrySeq &node = getNodeSeq(entry.getCreatorId());
   node.current = entry.getSeqNo();
   node.sending = entry.getSeqNo();
   node.final = entry.getSeqNo() < node.final ? node.final : entry.getSeqNo();
 }
 
+RepoSyncDelete::pipelineEntrySeq&
+RepoSyncDelete::getNodeSeq(CreatorId creator)
+{
+  if (creator >= m_nodeSeq.size())
+    m_nodeSeq.resize(creator + 1, pipelineEntrySeq());
+  return m_nodeSeq[creator];
+}
+
+ReorderBuffer&
+RepoSyncDelete::getReorderBuffer(CreatorId creator)
+{
+  if (creator >= m_reorderBuffers.size())
+    m_reorderBuffers.resize(creator + 1);
+  return m_reorderBuffers[creator];
+}
+
 void
 RepoSyncDelete::removeSnapshotEntry(std::pair<Name, uint64_t> info)
 {
@@ -1156,15 +1578,7 @@ RepoSyncDelete::removeSnapshotEntry(std::pair<Name, uint64_t> info)
 void
 RepoSyncDelete::removeIndexEntry()
 {
-  for (std::map<Name, status>::iterator it = m_storageHandle.begin(); it != m_storageHandle.end();)
-  {
-    if (it->second == DELETED)
-    {
-      m_storageHandle.erase(it++);
-    }
-    else
-      it++;
-  }
+  m_storageHandle.removeDeleted();
   m_scheduler.schedule(ns3::Seconds(50), bind(&RepoSyncDelete::removeIndexEntry, this), REMOVE_INDEX_ENTRY);
 }
 
@@ -20,11 +20,21 @@
 #ifndef REPO_SYNC_REPO_SYNC_HPP
 #define REPO_SYNC_REPO_SYNC_HPP
 #include <boost/random.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "common.hpp"
 #include "action-entry.hpp"
 #include "sync-digest.hpp"
 #include "sync-tree.hpp"
+#include "action-log.hpp"
+#include "creator-table.hpp"
+#include "fetch-window.hpp"
+#include "fetch-dispatcher.hpp"
+#include "workload-source.hpp"
+#include "reorder-buffer.hpp"
+#include "snapshot-fetcher.hpp"
+#include "delta-chain.hpp"
+#include "data-index.hpp"
 #include "sync-msg.hpp"
 #include "sync-scheduler.h"
 #include "sync-ccnx-wrapper.hpp"
@@ -80,9 +90,35 @@ public:
   void
   stop();
 
+  /**
+   * @brief  data names with the action ("insertion" or "deletion") applied to them
+   */
+  typedef std::vector<std::pair<Name, std::string> > ActionBatch;
+
   void
   insertAction(const Name& dataName, const std::string& status);
 
+  /**
+   * @brief  commit the actions of a batch at once: they take consecutive sequence numbers,
+   *         the creator's entry in the sync tree is updated once and a single root digest is
+   *         produced for the whole batch
+   */
+  void
+  insertActions(const ActionBatch& batch);
+
+  /**
+   * @brief  generate the actions of the workload from 'start' on, the events are scheduled
+   *         under 'label' one at a time
+   */
+  void
+  startWorkload(boost::shared_ptr<WorkloadSource> workload, const Time& start, uint32_t label);
+
+  /**
+   * @brief  generate the actions of the workload that are due now and schedule the next one
+   */
+  void
+  generateActions(boost::shared_ptr<WorkloadSource> workload, uint32_t label);
+
   /**
    * @brief  print the infomation in sync tree with all the creator names and their sequence number
    */
@@ -103,13 +139,32 @@ private:
   void
   init();
 
+  /**
+   * @brief append an action to the action log under the current root digest
+   */
+  void
+  logAction(const ActionEntry& entry);
+
+  /**
+   * @brief refresh the snapshot once old actions have been evicted from the action log
+   */
+  void
+  onActionsEvicted(size_t count, const ActionLog::EvictedSeqs& seqs);
+
+  /**
+   * @brief serve the evicted actions through a new snapshot, the other actions of their
+   *        creators are still served from the action log
+   */
   void
-  onSyncInterest(const std::string &str);
+  snapshotEvictedActions();
+
+  void
+  onSyncInterest(const Name &name);
 
   void
   responseData(const Name& prefix);
 
-  DigestConstPtr
+  DigestValue
   convertNameToDigest(const Name &name);
 
   Action
@@ -142,6 +197,19 @@ private:
   void
   writeDataToSnapshot(Msg* msg, const Name& name, const status& stat);
 
+  /**
+   * @brief  write the data in segments of about SnapshotSegmentSize bytes, appended to the
+   *         segments after the first 'first' ones; at least one segment is appended
+   */
+  void
+  writeDataToSegments(const std::map<Name, status>& data, std::vector<Msg>& segments, size_t first);
+
+  /**
+   * @brief  write the snapshot info and the segment numbers to the segments of the snapshot
+   */
+  void
+  numberSnapshotSegments(std::vector<Msg>& segments);
+
   /**
    * @brief  remove the snapshot info in the snapshot list, this fuction will be called
    *         after the snapshot is applied for a period of time
@@ -149,9 +217,19 @@ private:
   void
   removeSnapshotEntry(std::pair<Name, uint64_t> info);
 
+  /**
+   * @brief  take the current data index and sync tree as the next snapshot, the snapshot
+   *         is only encoded when it is requested
+   */
   void
   createSnapshot();
 
+  /**
+   * @brief  encode the segments of the current snapshot and of its deltas, unless done already
+   */
+  void
+  materializeSnapshot();
+
   /**
    * @brief  apply the data in the snapshot to local database, whether insert (fetch),
    *         delete the data or do nothing is based on the status of the data in snapshot and database
@@ -165,13 +243,25 @@ private:
   void
   updateSyncTree(const ActionEntry& entry);
 
+  /**
+   * @brief  pipeline status of the creator, created on first use
+   */
+  pipelineEntrySeq&
+  getNodeSeq(CreatorId creator);
+
+  /**
+   * @brief  out of order actions of the creator, created on first use
+   */
+  ReorderBuffer&
+  getReorderBuffer(CreatorId creator);
+
   /**
    * @brief  periodically trigger the index to remove the entry with Deleted flag
    */
   void
   removeIndexEntry();
 
-  DigestConstPtr
+  const DigestValue&
   getDigest() const
   {
     return m_syncTree.getDigest();
@@ -181,11 +271,11 @@ private:  // process different kinds of interests
   /**
    * @brief  process sync interest
    * @param  Name              interest name
-   * @param  DigestConstPtr    the smart pointer of digest obtained from interest name
+   * @param  DigestValue       the digest obtained from interest name
    * @param  bool              used to indicate whether to process recovery process or not
    */
   void
-  processSyncInterest(const Name& name, DigestConstPtr digest, bool timeProcessing);
+  processSyncInterest(const Name& name, const DigestValue& digest, bool timeProcessing);
 
   /**
    * @brief  process sync interest
@@ -197,44 +287,108 @@ private:  // process different kinds of interests
   /**
    * @brief  process sync interest
    * @param  Name              interest name
-   * @param  DigestConstPtr    the smart pointer of digest obtained from interest name
+   * @param  DigestValue       the digest obtained from interest name
    */
   void
-  processRecoveryInterest(const Name& name, DigestConstPtr digest);
+  processRecoveryInterest(const Name& name, const DigestValue& digest);
 
+  /**
+   * @brief  answer a fetch interest with the first segment of the snapshot
+   */
   void
   sendSnapshot(const Name& name);
 
+  /**
+   * @brief  answer the request of a segment of the current snapshot
+   * @param  Name  interest name
+   */
+  void
+  processSnapshotInterest(const Name& name);
+
   /**
    * @brief  send interest response back, called by interests procession
    * @param  Name  data name
    * @param  Msg   the information data contain
    */
   void
-  sendData(const Name &name, Msg& ssm);
+  sendData(const Name &name, const Msg& ssm);
 
 private:  // send different kinds of interests
 
   void
   sendSyncInterest();
 
+  /**
+   * @brief  fetch the actions of the creator from 'from' to 'to' with one interest,
+   *         a single action is fetched with a fetch interest, several with a range interest
+   */
   void
-  sendFetchInterest(const Name& creatorName, const uint64_t& seq);
+  sendFetchInterest(CreatorId creator, const uint64_t& from, const uint64_t& to);
 
+  /**
+   * @brief  fetch the actions of the creator from 'from' to 'to', split in ranges of FetchRange
+   */
   void
-  sendRecoveryInterest(DigestConstPtr digest);
+  fetchActions(CreatorId creator, uint64_t from, uint64_t to);
 
+  /**
+   * @brief  queue the actions of the creator from 'from' to 'to' to be fetched on the next
+   *         tick of the fetch dispatcher
+   */
   void
-  onSyncTimeout(const std::string str);
+  queueFetch(CreatorId creator, uint64_t from, uint64_t to);
 
+  /**
+   * @brief  send the queued fetch interests of one tick
+   */
   void
-  onFetchTimeout(const std::string str);
+  dispatchFetches();
 
+  /**
+   * @brief  get the creator and the sequence numbers requested by a fetch or range interest
+   */
+  void
+  parseFetchName(const Name& name, Name& creator, uint64_t& from, uint64_t& to) const;
+
+  void
+  sendRecoveryInterest(const DigestValue& digest);
+
+  /**
+   * @brief  start recovery after a fetch interest has been retried too often
+   */
+  void
+  recoverFetch();
+
+  /**
+   * @brief  request the segments of the snapshot allowed by the window
+   */
   void
-  onRecoveryTimeout(const std::string str);
+  fetchSnapshotSegments(const SnapshotFetcher::SnapshotId& id);
 
   void
-  setFilterTimeout(const std::string str);
+  sendSnapshotInterest(const SnapshotFetcher::SnapshotId& id, uint64_t segment, int retries);
+
+  /**
+   * @brief  get the snapshot and the segment number requested by a snapshot or delta interest
+   * @return true for a delta interest, 'base' is then the snapshot the delta starts from
+   */
+  bool
+  parseSnapshotName(const Name& name, SnapshotFetcher::SnapshotId& id, uint64_t& base, uint64_t& segment) const;
+
+  void
+  onSyncTimeout(const Name &name);
+
+  void
+  onFetchTimeout(const Name &name);
+
+  void
+  onRecoveryTimeout(const Name &name);
+
+  void
+  onSnapshotTimeout(const Name &name);
+
+  void
+  setFilterTimeout(const Name &name);
 
 private:  // receive and process data of different kinds of response
 
@@ -242,7 +396,7 @@ private:  // receive and process data of different kinds of response
    * @brief  receive the responses of interests
    */
   void
-  onData(const std::string &name, const char *wireData, size_t len);
+  onData(const Name &name, const char *wireData, size_t len);
 
   void
   processSyncData(const Name& name, const char* wireData, size_t len);
@@ -253,21 +407,38 @@ private:  // receive and process data of different kinds of response
   void
   processRecoveryData(const Name& name, const char* wireData, size_t len);
 
+  void
+  processSnapshotData(const Name& name, const char* wireData, size_t len);
+
+  /**
+   * @brief  update the sync tree with a snapshot once all its data has been applied
+   */
+  void
+  applySnapshotTree(Msg& message);
+
   /**
    * @brief  after receive the sync interest response, prepare pipeline to send fetch interest
-   * @param  Name       creator name of the action that needs to be fetched
-   * @param  uint64_t   the sequnece number of action that needs to be fetched
+   * @param  CreatorId  id of the creator of the actions that need to be fetched
+   * @param  uint64_t   the lowest sequence number announced for the creator
+   * @param  uint64_t   the highest sequence number announced for the creator
    */
   void
-  prepareFetchForSync(const Name& name, const uint64_t seq, const uint64_t finalSeq);
+  prepareFetchForSync(CreatorId creator, const uint64_t first, const uint64_t last);
+
+  /**
+   * @brief  apply an action embedded in the sync interest response without fetching it
+   */
+  void
+  onEmbeddedAction(const ActionEntry& action);
 
   /**
    * @brief  after receive the recovery interest response, prepare pipeline to send fetch interest
-   * @param  Name       creator name of the action that needs to be fetched
-   * @param  uint64_t   the sequnece number of action that needs to be fetched
+   * @param  CreatorId  id of the creator of the actions that need to be fetched
+   * @param  uint64_t   the lowest sequence number announced for the creator
+   * @param  uint64_t   the highest sequence number announced for the creator
    */
   void
-  prepareFetchForRecovery(const Name& name, const uint64_t seq, const uint64_t finalSeq);
+  prepareFetchForRecovery(CreatorId creator, const uint64_t first, const uint64_t last);
 
 private:  // apply actions and fetch the data
 
@@ -288,10 +459,10 @@ private:  // apply actions and fetch the data
   sendNormalInterest(const Name& name);
 
   void
-  onFetchData(const std::string &name, const char *wireData, size_t len);
+  onFetchData(const Name &name, const char *wireData, size_t len);
 
   void
-  onDataTimeout(const std::string str);
+  onDataTimeout(const Name &name);
 
 private:
   Name m_syncPrefix;    // /ndn/broadcast/
@@ -303,23 +474,29 @@ private:
   Scheduler m_scheduler;
   CcnxWrapperPtr m_ccnxHandle;
   //Ptr<ApiFace> m_face;
-  std::list<std::pair<DigestPtr, ActionEntry> > m_actionList;
+  ActionLog m_actionLog;
+  ActionLog::EvictedSeqs m_evictedSeqs;                    // evicted actions not covered by a snapshot yet
 
   //  save the information of local generated actions to provide version number for same actions
   //  currently version number has no use, it can be further implemented to avoid generating
   //  same action continuely
   std::map<std::pair<Name, Action>, uint64_t> m_seqIndex;
 
-  // represent the status of actions with certain creator name
-  std::map<Name, pipelineEntrySeq> m_nodeSeq;
+  // represent the status of actions with certain creator, indexed by creator id
+  // deques keep the references handed out by getNodeSeq and getReorderBuffer valid while growing
+  std::deque<pipelineEntrySeq> m_nodeSeq;
+
+  // number of actions of each creator that may be fetched at the same time
+  FetchWindow m_fetchWindow;
 
-  // save actions out of order, name is the creatorName, used by the fething action pipeline
-  std::map<Name, std::list<ActionEntry> > m_pendingActionList;
+  // fetch interests queued by actionControl, sent once per tick
+  FetchDispatcher m_fetchDispatcher;
 
-  // record retry times of each action, name is /creatorName/seq
-  std::map<Name, int> m_retryTable;
+  // save actions out of order, indexed by creator id, used by the fething action pipeline
+  std::deque<ReorderBuffer> m_reorderBuffers;
 
-  std::map<Name, int> m_reTransmit;
+  // record retry times of each action
+  boost::unordered_map<ActionKey, int> m_retryTable;
 
   enum EventLabels
     {
@@ -331,7 +508,10 @@ private:
       REMOVE_SNAPSHOT = 6,
       REMOVE_INDEX_ENTRY = 7,
       GENERATE_ACTION = 8,
-      START = 9
+      START = 9,
+      EVICT_ACTIONS = 10,
+      RECOVER_FETCH = 11,
+      DISPATCH_FETCH = 12
     };
   SyncTree m_syncTree;
   uint32_t m_recoveryRetransmissionInterval; // milliseconds
@@ -340,14 +520,45 @@ private:
   boost::variate_generator<boost::mt19937&, boost::uniform_int<> > m_reexpressionJitter;
   boost::variate_generator<boost::mt19937&, boost::uniform_int<> > m_senddataJitter;
   SyncInterestTable m_syncInterestTable;
-  Msg m_snapshot;
+  MsgPool m_msgPool;                                       // received data is decoded into these messages
+  DataIndex::View m_snapshotData;                          // the epoch of the data index of the current snapshot
+  std::vector<std::pair<Name, uint64_t> > m_snapshotTree;  // the sync tree of the current snapshot
+  std::vector<Msg> m_snapshot;   // segments of the current snapshot, built on the first request
   uint64_t m_snapshotNo;
   std::list<std::pair<Name, uint64_t> > m_snapshotList;
+  SnapshotFetcher m_snapshotFetcher;
+  DeltaChain m_deltaChain;
+  std::vector<std::vector<Msg> > m_deltas;        // segments of the deltas to the current snapshot, oldest base first
+  std::map<Name, uint64_t> m_appliedSnapshots;    // the last snapshot applied from each repo
 
-  std::map<Name, status> m_storageHandle;
+  DataIndex m_storageHandle;
 
   std::string m_master;
 
+  std::string m_digestMode;
+  std::string m_msgEncoding;
+  Msg::Encoding m_encoding;
+  uint32_t m_actionLogBudget;
+  uint32_t m_fetchRange;
+  uint32_t m_syncReplyBudget;
+  uint32_t m_snapshotSegmentSize;
+  uint32_t m_snapshotWindow;
+  uint32_t m_snapshotDeltas;
+  Time m_schedulerTick;
+  std::string m_workload;
+  Name m_workloadPrefix;
+  uint32_t m_workloadCount;
+  Time m_workloadStart;
+  Time m_workloadInterval;
+  std::string m_workloadTrace;
+  uint32_t m_windowInitial;
+  uint32_t m_windowMin;
+  uint32_t m_windowMax;
+  double m_windowIncrease;
+  double m_windowDecrease;
+  Time m_fetchTick;
+  uint32_t m_fetchBudget;
+
   uint64_t m_start;
 
   uint64_t m_size;
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "retransmission-timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+namespace ndn {
+
+// gains of the smoothed RTT and of the RTT variation
+static const double RTT_ALPHA = 0.125;
+static const double RTT_BETA = 0.25;
+static const double RTTVAR_FACTOR = 4;
+
+RetransmissionTimer::RetransmissionTimer(const Time& initial, const Time& minimum,
+                                         const Time& maximum)
+  : m_initial(initial.GetSeconds())
+  , m_minimum(minimum.GetSeconds())
+  , m_maximum(std::max(maximum.GetSeconds(), minimum.GetSeconds()))
+  , m_srtt(0)
+  , m_rttvar(0)
+  , m_hasMeasurement(false)
+{
+}
+
+void
+RetransmissionTimer::addMeasurement(const Time& rtt)
+{
+  double sample = rtt.GetSeconds();
+  if (!m_hasMeasurement) {
+    m_srtt = sample;
+    m_rttvar = sample / 2;
+    m_hasMeasurement = true;
+  }
+  else {
+    m_rttvar = (1 - RTT_BETA) * m_rttvar + RTT_BETA * std::fabs(m_srtt - sample);
+    m_srtt = (1 - RTT_ALPHA) * m_srtt + RTT_ALPHA * sample;
+  }
+}
+
+Time
+RetransmissionTimer::getTimeout(uint32_t retries) const
+{
+  double timeout = (m_hasMeasurement ? m_srtt + RTTVAR_FACTOR * m_rttvar : m_initial);
+  timeout = std::max(timeout, m_minimum);
+  for (uint32_t i = 0; i < retries && timeout < m_maximum; ++i)
+    timeout *= 2;
+  return Seconds(std::min(timeout, m_maximum));
+}
+
+} // namespace ndn
+} // namespace ns3
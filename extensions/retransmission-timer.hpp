@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef REPO_SYNC_RETRANSMISSION_TIMER_HPP
+#define REPO_SYNC_RETRANSMISSION_TIMER_HPP
+
+#include <ns3/nstime.h>
+
+#include <boost/cstdint.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Retransmission timeout estimated from measured round trip times
+ *
+ * Smoothed RTT and RTT variation are kept as in Jacobson/Karels (RFC 6298): the timeout
+ * is SRTT + 4 * RTTVAR, clamped to [minimum, maximum], and doubled for every retry of the
+ * same interest.  Only replies to interests that were sent once should be measured, a
+ * reply to a retransmitted interest cannot be matched to one of its transmissions.
+ */
+class RetransmissionTimer
+{
+public:
+  /**
+   * @param initial  timeout used before the first measurement
+   * @param minimum  lower bound of the timeout
+   * @param maximum  upper bound of the timeout, also with backoff
+   */
+  RetransmissionTimer(const Time& initial = Seconds(1),
+                      const Time& minimum = MilliSeconds(200),
+                      const Time& maximum = Seconds(4));
+
+  void
+  addMeasurement(const Time& rtt);
+
+  /**
+   * @brief timeout of an interest that has been retransmitted 'retries' times
+   */
+  Time
+  getTimeout(uint32_t retries = 0) const;
+
+  Time
+  getSmoothedRtt() const
+  {
+    return Seconds(m_srtt);
+  }
+
+  bool
+  hasMeasurement() const
+  {
+    return m_hasMeasurement;
+  }
+
+private:
+  double m_initial;   // all times in seconds
+  double m_minimum;
+  double m_maximum;
+  double m_srtt;
+  double m_rttvar;
+  bool m_hasMeasurement;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_RETRANSMISSION_TIMER_HPP
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "snapshot-fetcher.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+SnapshotFetcher::Transfer::Transfer()
+  : head(SyncStateMsg::SNAPSHOT)
+  , isDelta(false)
+  , base(0)
+  , firstSegment(1)
+  , finalSegment(0)
+  , next(1)
+  , missing(0)
+  , outstanding(0)
+{
+}
+
+SnapshotFetcher::SnapshotFetcher()
+  : m_window(8)
+{
+}
+
+void
+SnapshotFetcher::setWindow(uint32_t window)
+{
+  m_window = (window > 0 ? window : 1);
+}
+
+bool
+SnapshotFetcher::isFetching(const SnapshotId& id) const
+{
+  return m_transfers.find(id) != m_transfers.end();
+}
+
+void
+SnapshotFetcher::start(const SnapshotId& id, uint64_t finalSegment, Msg& head)
+{
+  start(id, 1, finalSegment, head);
+}
+
+void
+SnapshotFetcher::startDelta(const SnapshotId& id, uint64_t base, uint64_t finalSegment, Msg& head)
+{
+  start(id, 0, finalSegment, head);
+  Transfer& transfer = m_transfers[id];
+  transfer.isDelta = true;
+  transfer.base = base;
+}
+
+void
+SnapshotFetcher::start(const SnapshotId& id, uint64_t firstSegment, uint64_t finalSegment, Msg& head)
+{
+  Transfer& transfer = m_transfers[id];
+  transfer.head.swap(head);
+  transfer.isDelta = false;
+  transfer.base = 0;
+  transfer.firstSegment = firstSegment;
+  transfer.finalSegment = finalSegment;
+  transfer.next = firstSegment;
+  transfer.missing = finalSegment + 1 - firstSegment;
+  transfer.outstanding = 0;
+  transfer.received.assign(finalSegment + 1, false);
+  transfer.timeouts.assign(finalSegment + 1, 0);
+}
+
+bool
+SnapshotFetcher::getDeltaBase(const SnapshotId& id, uint64_t& base) const
+{
+  TransferMap::const_iterator it = m_transfers.find(id);
+  if (it == m_transfers.end() || !it->second.isDelta)
+    return false;
+  base = it->second.base;
+  return true;
+}
+
+bool
+SnapshotFetcher::nextSegment(const SnapshotId& id, uint64_t& segment)
+{
+  TransferMap::iterator it = m_transfers.find(id);
+  if (it == m_transfers.end())
+    return false;
+  Transfer& transfer = it->second;
+  if (transfer.outstanding >= m_window || transfer.next > transfer.finalSegment)
+    return false;
+  segment = transfer.next++;
+  transfer.outstanding++;
+  return true;
+}
+
+bool
+SnapshotFetcher::onSegment(const SnapshotId& id, uint64_t segment)
+{
+  TransferMap::iterator it = m_transfers.find(id);
+  if (it == m_transfers.end())
+    return false;
+  Transfer& transfer = it->second;
+  if (segment < transfer.firstSegment || segment >= transfer.next || transfer.received[segment])
+    return false;
+  transfer.received[segment] = true;
+  transfer.missing--;
+  transfer.outstanding--;
+  return true;
+}
+
+int
+SnapshotFetcher::onTimeout(const SnapshotId& id, uint64_t segment)
+{
+  TransferMap::iterator it = m_transfers.find(id);
+  if (it == m_transfers.end())
+    return 0;
+  Transfer& transfer = it->second;
+  if (segment < transfer.firstSegment || segment >= transfer.next || transfer.received[segment])
+    return 0;
+  return ++transfer.timeouts[segment];
+}
+
+bool
+SnapshotFetcher::finish(const SnapshotId& id, Msg& head)
+{
+  TransferMap::iterator it = m_transfers.find(id);
+  if (it == m_transfers.end() || it->second.missing > 0)
+    return false;
+  head.swap(it->second.head);
+  m_transfers.erase(it);
+  return true;
+}
+
+void
+SnapshotFetcher::abort(const SnapshotId& id)
+{
+  m_transfers.erase(id);
+}
+
+} // namespace ndn
+} // namespace ns3
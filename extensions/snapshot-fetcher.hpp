@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_SNAPSHOT_FETCHER_HPP
+#define REPO_SYNC_SNAPSHOT_FETCHER_HPP
+
+#include "common.hpp"
+#include "sync-msg.hpp"
+
+#include <map>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Segmented snapshots being fetched
+ *
+ * A large snapshot is published as numbered segments.  Segment 0 answers the fetch interest
+ * and tells the final segment number, the others are requested with a window of segments on
+ * the way.  Segment 0 may also announce deltas, the changes since earlier snapshots, which
+ * are published as segments of their own and fetched instead of the data of the snapshot.
+ * Every segment is applied as soon as it arrives; the sync tree, carried by segment 0, is kept
+ * until all the segments have been received.
+ */
+class SnapshotFetcher
+{
+public:
+  // the repo that generated the snapshot and the version of the snapshot
+  typedef std::pair<Name, uint64_t> SnapshotId;
+
+  SnapshotFetcher();
+
+  /**
+   * @brief  number of segments of a snapshot that may be on the way
+   */
+  void
+  setWindow(uint32_t window);
+
+  bool
+  isFetching(const SnapshotId& id) const;
+
+  /**
+   * @brief  start fetching segments 1 to 'finalSegment', segment 0 has been received
+   * @param  head  segment 0, its content is taken over until the snapshot is complete
+   */
+  void
+  start(const SnapshotId& id, uint64_t finalSegment, Msg& head);
+
+  /**
+   * @brief  start fetching segments 0 to 'finalSegment' of the delta from snapshot 'base'
+   * @param  head  segment 0 of the snapshot, its content is taken over until the delta is complete
+   */
+  void
+  startDelta(const SnapshotId& id, uint64_t base, uint64_t finalSegment, Msg& head);
+
+  /**
+   * @brief  the base of the delta being fetched for the snapshot
+   * @return false if the segments of the snapshot itself are fetched
+   */
+  bool
+  getDeltaBase(const SnapshotId& id, uint64_t& base) const;
+
+  /**
+   * @brief  next segment to request
+   * @return false if the window is full or all the segments have been requested
+   */
+  bool
+  nextSegment(const SnapshotId& id, uint64_t& segment);
+
+  /**
+   * @brief  a segment has been received
+   * @return false if the segment is not expected, i.e. unknown snapshot or duplicate
+   */
+  bool
+  onSegment(const SnapshotId& id, uint64_t segment);
+
+  /**
+   * @brief  the request of a segment timed out
+   * @return the number of timeouts of the segment, 0 if the segment is no longer expected
+   */
+  int
+  onTimeout(const SnapshotId& id, uint64_t segment);
+
+  /**
+   * @brief  once all the segments have been received, give back segment 0 and forget the snapshot
+   * @return false if segments are still missing
+   */
+  bool
+  finish(const SnapshotId& id, Msg& head);
+
+  /**
+   * @brief  give up fetching the snapshot
+   */
+  void
+  abort(const SnapshotId& id);
+
+private:
+  struct Transfer
+  {
+    Transfer();
+
+    Msg head;
+    bool isDelta;
+    uint64_t base;
+    uint64_t firstSegment;
+    uint64_t finalSegment;
+    uint64_t next;              // the next segment to request
+    uint64_t missing;           // segments not received yet
+    uint32_t outstanding;       // segments requested and not received yet
+    std::vector<bool> received;
+    std::vector<int> timeouts;
+  };
+
+  typedef std::map<SnapshotId, Transfer> TransferMap;
+
+  void
+  start(const SnapshotId& id, uint64_t firstSegment, uint64_t finalSegment, Msg& head);
+
+private:
+  TransferMap m_transfers;
+  uint32_t m_window;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_SNAPSHOT_FETCHER_HPP
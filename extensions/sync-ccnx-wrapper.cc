@@ -86,10 +86,10 @@ CcnxWrapper::publishRawData (const std::string &name, const char *buf, size_t le
 
 
 void
-RawDataCallback2StringDataCallback (CcnxWrapper::StringDataCallback callback, CcnxWrapper::TimeoutCallback timeout, std::string str, const char *buf, size_t len)
+RawDataCallback2StringDataCallback (CcnxWrapper::StringDataCallback callback, CcnxWrapper::TimeoutCallback timeout, const Name &name, const char *buf, size_t len)
 {
-  callback (str, string (buf, len));
-  timeout(str);
+  callback (name.toUri (), string (buf, len));
+  timeout(name);
 }
 
 /*
@@ -100,25 +100,30 @@ CcnxWrapper::sendInterestForString (const std::string &strInterest, const String
                        boost::bind (RawDataCallback2StringDataCallback, strDataCallback, _1, _2, _3));
 }*/
 
-int CcnxWrapper::sendInterest (const string &strInterest, const RawDataCallback &rawDataCallback, const TimeoutCallback& timeout)
+int CcnxWrapper::sendInterest (const Name &interestName, const RawDataCallback &rawDataCallback, const TimeoutCallback& timeout,
+                               const Time &lifetime, bool measureRtt)
 {
-  _LOG_INFO (">> Requesting Interest: " << strInterest);
-  Ptr<ndn::Name> name = Create<ndn::Name> (strInterest);
+  _LOG_INFO (">> Requesting Interest: " << interestName);
+  Ptr<ndn::Name> name = Create<ndn::Name> (interestName);
 
   Ptr<ndn::Interest> interest = Create<ndn::Interest> ();
   interest->SetNonce            (m_rand.GetValue ());
-  interest->SetName             (*name);
-  interest->SetInterestLifetime (Seconds (4.1)); // really long-lived interests
+  interest->SetName             (name);
+  interest->SetInterestLifetime (lifetime);
   
-  // Record the callback
+  // Record the callback.  An Interest expressed again replaces the pending one, so that its
+  // lifetime and send time are used, but the reply cannot be matched to one of the two Interests
   CcnxFilterEntryContainer<RawDataCallback, TimeoutCallback>::iterator entry = m_dataCallbacks.find_exact (*name);
-  if (entry == m_dataCallbacks.end ())
+  if (entry != m_dataCallbacks.end ())
     {
-      pair<CcnxFilterEntryContainer<RawDataCallback, TimeoutCallback>::iterator, bool> status =
-        m_dataCallbacks.insert (*name, Create< CcnxFilterEntry<RawDataCallback, TimeoutCallback> > (interest));
-
-      entry = status.first;
+      m_dataCallbacks.erase (entry);
+      measureRtt = false;
     }
+  pair<CcnxFilterEntryContainer<RawDataCallback, TimeoutCallback>::iterator, bool> status =
+    m_dataCallbacks.insert (*name, Create< CcnxFilterEntry<RawDataCallback, TimeoutCallback> > (interest));
+
+  entry = status.first;
+  entry->payload ()->m_measureRtt = measureRtt;
   entry->payload ()->AddCallback (rawDataCallback, timeout);
 
   m_transmittedInterests (interest, this, m_face);
@@ -127,7 +132,7 @@ int CcnxWrapper::sendInterest (const string &strInterest, const RawDataCallback
   return 0;
 }
 
-int CcnxWrapper::setInterestFilter (const string &prefix, const InterestCallback &interestCallback, const TimeoutCallback& timeout)
+int CcnxWrapper::setInterestFilter (const Name &prefix, const InterestCallback &interestCallback, const TimeoutCallback& timeout)
 {
   //NS_LOG_INFO ("== setInterestFilter " << prefix << " (" << GetNode ()->GetId () << ")");
   Ptr<ndn::Name> name = Create<ndn::Name> (prefix);
@@ -158,11 +163,9 @@ int CcnxWrapper::setInterestFilter (const string &prefix, const InterestCallback
 }
 
 void
-CcnxWrapper::clearInterestFilter (const std::string &prefix)
+CcnxWrapper::clearInterestFilter (const Name &prefix)
 {
-  Ptr<ndn::Name> name = Create<ndn::Name> (prefix);
-
-  CcnxFilterEntryContainer<InterestCallback, TimeoutCallback>::iterator entry = m_interestCallbacks.find_exact (*name);
+  CcnxFilterEntryContainer<InterestCallback, TimeoutCallback>::iterator entry = m_interestCallbacks.find_exact (prefix);
   if (entry == m_interestCallbacks.end ())
     return;
 
@@ -182,7 +185,7 @@ CcnxWrapper::OnInterest (ns3::Ptr<const ndn::Interest> interest)
       return;
     }
   
-  entry->payload ()->m_callback (lexical_cast<string> (interest->GetName ()));  
+  entry->payload ()->m_callback (interest->GetName ());
 }
 
 void
@@ -199,17 +202,28 @@ CcnxWrapper::OnData (ns3::Ptr<const ndn::Data> contentObject)
       return;
     }
 
+  // the payload is copied once for all the callbacks.  The buffer is taken from the wrapper
+  // while they run, so a Data delivered by one of them gets a buffer of its own
+  std::vector<char> payload;
+  payload.swap (m_payload);
+  Ptr<const Packet> packet = contentObject->GetPayload ();
+  payload.resize (packet->GetSize ());
+  if (!payload.empty ())
+    packet->CopyData (reinterpret_cast<uint8_t*> (&payload[0]), payload.size ());
+
   while (entry != m_dataCallbacks.end ())
     {
-      ostringstream content;
-      contentObject->GetPayload()->CopyData (&content, contentObject->GetPayload()->GetSize ());
-  
-      entry->payload ()->m_callback (lexical_cast<string> (contentObject->GetName ()), content.str ().c_str (), content.str ().size ());
-  
+      if (entry->payload ()->m_measureRtt)
+        m_retransmissionTimer.addMeasurement (Simulator::Now () - entry->payload ()->m_sendTime);
+
+      entry->payload ()->m_callback (contentObject->GetName (), payload.empty () ? 0 : &payload[0], payload.size ());
+
       m_dataCallbacks.erase (entry);
 
       entry = m_dataCallbacks.longest_prefix_match (contentObject->GetName ());
     }
+
+  payload.swap (m_payload);
 }
 
 }
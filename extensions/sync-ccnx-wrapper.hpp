@@ -39,6 +39,7 @@
 #include <ns3/ndnSIM/utils/trie/trie-with-policy.h>
 #include <ns3/ndnSIM/utils/trie/counting-policy.h>
 #include "timeouts-policy.h"
+#include "retransmission-timer.hpp"
 /**
  * \defgroup sync SYNC protocol
  *
@@ -54,8 +55,10 @@ struct CcnxFilterEntry : public ns3::SimpleRefCount< CcnxFilterEntry<Callback, T
 public:
 
   CcnxFilterEntry (ns3::Ptr<const ns3::ndn::Interest> interest)
-    : m_prefix(Create<Name>(interest->GetName()))
+    : m_prefix(interest->GetNamePtr())
     , m_interest(interest) 
+    , m_sendTime(Simulator::Now())
+    , m_measureRtt(false)
   { }
   
   const ns3::ndn::Name &
@@ -84,7 +87,7 @@ public:
   void
   ProcessOnTimeout (Ptr<const Interest> interest)
   {
-    m_timeout(interest->GetName().toUri());
+    m_timeout(interest->GetName());
   }
 
   
@@ -93,6 +96,8 @@ public:
   Ptr<const Interest> m_interest;
   Callback m_callback;
   Timeout m_timeout;
+  Time m_sendTime;   ///< \brief When the interest was expressed
+  bool m_measureRtt; ///< \brief Whether the reply is a round trip time sample
 };
 
 
@@ -116,9 +121,9 @@ class CcnxWrapper
 {
 public:
   typedef boost::function<void (std::string, std::string)> StringDataCallback;
-  typedef boost::function<void (std::string, const char *buf, size_t len)> RawDataCallback;
-  typedef boost::function<void (std::string)> InterestCallback;
-  typedef boost::function<void (std::string)> TimeoutCallback;
+  typedef boost::function<void (const Name &, const char *buf, size_t len)> RawDataCallback;
+  typedef boost::function<void (const Name &)> InterestCallback;
+  typedef boost::function<void (const Name &)> TimeoutCallback;
 
   
   /**
@@ -132,15 +137,29 @@ public:
   /**
    * @brief send Interest; need to grab lock m_mutex first
    *
-   * @param strInterest the Interest name
+   * @param interestName the Interest name
    * @param dataCallback the callback function to deal with the returned data
+   * @param lifetime the Interest lifetime, the timeout callback is called when it expires
+   * @param measureRtt whether the reply updates the retransmission timer; should only be
+   *        set for Interests that are sent for the first time
    * @return the return code of ccn_express_interest
    */
   //int
   //sendInterestForString (const std::string &strInterest, const StringDataCallback &strDataCallback, const TimeoutCallback& timeout);
 
   int
-  sendInterest (const std::string &strInterest, const RawDataCallback &rawDataCallback, const TimeoutCallback& timeout);
+  sendInterest (const Name &interestName, const RawDataCallback &rawDataCallback, const TimeoutCallback& timeout,
+                const Time &lifetime = Seconds (4.1), bool measureRtt = false);
+
+  /**
+   * @brief lifetime for an Interest that has been retransmitted 'retries' times,
+   * estimated from the round trip times measured on this face
+   */
+  Time
+  getRetransmissionTimeout (uint32_t retries) const
+  {
+    return m_retransmissionTimer.getTimeout (retries);
+  }
   
   /**
    * @brief set Interest filter (specify what interest you want to receive)
@@ -150,14 +169,14 @@ public:
    * @return the return code of ccn_set_interest_filter
    */
   int
-  setInterestFilter (const std::string &prefix, const InterestCallback &interestCallback, const TimeoutCallback& timeout);
+  setInterestFilter (const Name &prefix, const InterestCallback &interestCallback, const TimeoutCallback& timeout);
 
   /**
    * @brief clear Interest filter
    * @param prefix the prefix of Interest
    */
   void
-  clearInterestFilter (const std::string &prefix);
+  clearInterestFilter (const Name &prefix);
 
   /**
    * @brief publish data and put it to local ccn content store; need to grab
@@ -206,6 +225,8 @@ private:
 
   CcnxFilterEntryContainer<RawDataCallback, TimeoutCallback> m_dataCallbacks;
   CcnxFilterEntryContainer<InterestCallback, TimeoutCallback> m_interestCallbacks;
+  RetransmissionTimer m_retransmissionTimer;
+  std::vector<char> m_payload; ///< \brief Buffer the payload of a Data is copied to, kept for the next Data
 };
 
 typedef boost::shared_ptr<CcnxWrapper> CcnxWrapperPtr;
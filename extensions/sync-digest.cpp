@@ -60,9 +60,8 @@ struct hex_from_4_bit
   }
 };
 
-typedef transform_iterator<hex_from_4_bit<std::vector<uint8_t>::const_iterator::value_type>,
-                           transform_width<std::vector<uint8_t>::const_iterator, 4, 8,
-                           std::vector<uint8_t>::const_iterator::value_type> > string_from_binary;
+typedef transform_iterator<hex_from_4_bit<uint8_t>,
+                           transform_width<const uint8_t*, 4, 8, uint8_t> > string_from_binary;
 
 
 template<class CharType>
@@ -99,102 +98,167 @@ typedef transform_width<transform_iterator<hex_to_4_bit<std::string::const_itera
 namespace ns3 {
 namespace ndn {
 
-Digest::Digest()
+namespace {
+
+/**
+ * @brief Pool of libcrypto contexts shared by all DigestBuilder instances
+ *
+ * Builders are short-lived and rarely nested, so the pool normally holds one or two contexts
+ */
+class DigestContextPool : noncopyable
 {
-  m_context = EVP_MD_CTX_create();
-  reset();
+public:
+  ~DigestContextPool()
+  {
+    for (std::vector<EVP_MD_CTX*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+      EVP_MD_CTX_destroy(*it);
+  }
+
+  EVP_MD_CTX *
+  borrow()
+  {
+    if (m_free.empty())
+      return EVP_MD_CTX_create();
+
+    EVP_MD_CTX *context = m_free.back();
+    m_free.pop_back();
+    return context;
+  }
+
+  void
+  release(EVP_MD_CTX *context)
+  {
+    m_free.push_back(context);
+  }
+
+private:
+  std::vector<EVP_MD_CTX*> m_free;
+};
+
+DigestContextPool&
+getContextPool()
+{
+  static DigestContextPool pool;
+  return pool;
 }
 
-Digest::~Digest()
+} // anonymous namespace
+
+DigestValue::DigestValue()
 {
-  EVP_MD_CTX_destroy(m_context);
+  memset(m_buffer, 0, SIZE);
 }
 
-bool
-Digest::empty() const
+DigestValue::DigestValue(const uint8_t *buffer)
 {
-  return m_buffer.empty();
+  memcpy(m_buffer, buffer, SIZE);
 }
 
 bool
-Digest::isZero() const
+DigestValue::isZero() const
 {
-  if (m_buffer.empty())
-    BOOST_THROW_EXCEPTION (Error::DigestCalculationError()
-                           << errmsg_info_str("Digest has not been yet finalized"));
+  for (std::size_t i = 0; i < SIZE; i++)
+    if (m_buffer[i] != 0)
+      return false;
 
-  return (m_buffer.size() == 1 && m_buffer[0] == 0);
+  return true;
 }
 
+std::size_t
+DigestValue::getHash() const
+{
+  // just getting first sizeof(std::size_t) bytes
+  // not ideal, but should work pretty well
+  std::size_t hash;
+  memcpy(&hash, m_buffer, sizeof(std::size_t));
+  return hash;
+}
 
-void
-Digest::reset()
+bool
+DigestValue::operator == (const DigestValue &digest) const
 {
-  m_buffer.clear();
+  return memcmp(m_buffer, digest.m_buffer, SIZE) == 0;
+}
 
-  int ok = EVP_DigestInit_ex(m_context, HASH_FUNCTION(), 0);
-  if (!ok)
-    BOOST_THROW_EXCEPTION (Error::DigestCalculationError()
-                           << errmsg_info_str("EVP_DigestInit_ex returned error")
-                           << errmsg_info_int(ok));
+bool
+DigestValue::operator < (const DigestValue &digest) const
+{
+  return memcmp(m_buffer, digest.m_buffer, SIZE) < 0;
 }
 
+DigestValue &
+DigestValue::operator += (const DigestValue &digest)
+{
+  unsigned int carry = 0;
+  for (std::size_t i = SIZE; i > 0; i--) {
+    unsigned int sum = m_buffer[i - 1] + digest.m_buffer[i - 1] + carry;
+    m_buffer[i - 1] = static_cast<uint8_t>(sum & 0xff);
+    carry = sum >> 8;
+  }
+  return *this;
+}
 
-void
-Digest::finalize()
+DigestValue &
+DigestValue::operator -= (const DigestValue &digest)
 {
-  if (!m_buffer.empty()) return;
+  int borrow = 0;
+  for (std::size_t i = SIZE; i > 0; i--) {
+    int diff = static_cast<int>(m_buffer[i - 1]) - digest.m_buffer[i - 1] - borrow;
+    borrow = diff < 0 ? 1 : 0;
+    m_buffer[i - 1] = static_cast<uint8_t>(diff + (borrow << 8));
+  }
+  return *this;
+}
 
-  m_buffer.resize (HASH_FUNCTION_LEN);
 
-  unsigned int tmp;
-  int ok = EVP_DigestFinal_ex(m_context,
-                              &m_buffer[0], &tmp);
-  if (!ok)
-    BOOST_THROW_EXCEPTION (Error::DigestCalculationError()
-                           << errmsg_info_str("EVP_DigestFinal_ex returned error")
-                           << errmsg_info_int(ok));
+DigestBuilder::DigestBuilder()
+  : m_context(getContextPool().borrow())
+  , m_finalized(false)
+{
+  reset();
 }
 
-std::size_t
-Digest::getHash() const
+DigestBuilder::~DigestBuilder()
 {
-  if (isZero()) return 0;
+  getContextPool().release(m_context);
+}
 
-  if (sizeof(std::size_t) > m_buffer.size())
-    {
-      BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
-                            << errmsg_info_str("Hash is not zero and length is less than size_t")
-                            << errmsg_info_int(m_buffer.size()));
-    }
+void
+DigestBuilder::reset()
+{
+  m_finalized = false;
 
-  // just getting first sizeof(std::size_t) bytes
-  // not ideal, but should work pretty well
-  return *(reinterpret_cast<const std::size_t*>(&m_buffer[0]));
+  int ok = EVP_DigestInit_ex(m_context, HASH_FUNCTION(), 0);
+  if (!ok)
+    BOOST_THROW_EXCEPTION (Error::DigestCalculationError()
+                           << errmsg_info_str("EVP_DigestInit_ex returned error")
+                           << errmsg_info_int(ok));
 }
 
-bool
-Digest::operator == (const Digest &digest) const
+DigestValue
+DigestBuilder::finalize()
 {
-  if (m_buffer.empty())
+  if (m_finalized)
     BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
-                          << errmsg_info_str("Digest1 is empty"));
+                          << errmsg_info_str("Digest has been already finalized"));
 
-  if (digest.m_buffer.empty())
-    BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
-                          << errmsg_info_str("Digest2 is empty"));
+  uint8_t buffer[HASH_FUNCTION_LEN];
+  unsigned int tmp;
+  int ok = EVP_DigestFinal_ex(m_context, buffer, &tmp);
+  if (!ok)
+    BOOST_THROW_EXCEPTION (Error::DigestCalculationError()
+                           << errmsg_info_str("EVP_DigestFinal_ex returned error")
+                           << errmsg_info_int(ok));
+  m_finalized = true;
 
-  return m_buffer == digest.m_buffer;
+  return DigestValue(buffer);
 }
 
-
 void
-Digest::update(const uint8_t *buffer, size_t size)
+DigestBuilder::update(const uint8_t *buffer, size_t size)
 {
-  // cout << "Update: " << (void*)buffer << " / size: " << size << "\n";
-
   // cannot update Digest when it has been finalized
-  if (!m_buffer.empty())
+  if (m_finalized)
     BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
                           << errmsg_info_str("Digest has been already finalized"));
 
@@ -205,42 +269,35 @@ Digest::update(const uint8_t *buffer, size_t size)
                            << errmsg_info_int(ok));
 }
 
-
-Digest &
-Digest::operator << (const Digest &src)
+DigestBuilder &
+DigestBuilder::operator << (const DigestValue &src)
 {
-  if (src.m_buffer.empty())
-    BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
-                          << errmsg_info_str ("Digest has not been yet finalized"));
-
-  update (&src.m_buffer[0], src.m_buffer.size());
+  update (src.data(), src.size());
 
   return *this;
 }
 
-Digest &
-Digest::operator << (uint64_t value)
+DigestBuilder &
+DigestBuilder::operator << (uint64_t value)
 {
   update(reinterpret_cast<const uint8_t*> (&value), sizeof(uint64_t));
   return *this;
 }
 
 std::ostream &
-operator << (std::ostream &os, const Digest &digest)
+operator << (std::ostream &os, const DigestValue &digest)
 {
-  BOOST_ASSERT (!digest.m_buffer.empty());
-
   std::ostreambuf_iterator<char> out_it(os); // ostream iterator
-  // need to encode to base64
-  copy(string_from_binary(digest.m_buffer.begin()),
-       string_from_binary(digest.m_buffer.end()),
+  // need to encode to hex
+  copy(string_from_binary(digest.data()),
+       string_from_binary(digest.data() + digest.size()),
        out_it);
 
   return os;
 }
 
 std::istream &
-operator >> (std::istream &is, Digest &digest)
+operator >> (std::istream &is, DigestValue &digest)
 {
   std::string str;
   is >> str; // read string first
@@ -249,19 +306,14 @@ operator >> (std::istream &is, Digest &digest)
     BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
                           << errmsg_info_str("Input is empty"));
 
-  // uint8_t padding = (3 - str.size () % 3) % 3;
-  // for (uint8_t i = 0; i < padding; i++) str.push_back ('=');
-
-  // only empty digest object can be used for reading
-  if (!digest.m_buffer.empty())
+  if (str.size() != 2 * DigestValue::SIZE)
     BOOST_THROW_EXCEPTION(Error::DigestCalculationError()
-                           << errmsg_info_str("Digest has been already finalized"));
-
-  digest.m_buffer.clear();
+                          << errmsg_info_str("Input has wrong length")
+                          << errmsg_info_int(str.size()));
 
   copy(string_to_binary(str.begin()),
        string_to_binary(str.end()),
-       std::back_inserter(digest.m_buffer));
+       digest.m_buffer);
 
   return is;
 }
@@ -33,67 +33,128 @@
 namespace ns3 {
 namespace ndn {
 
+namespace Error {
+struct DigestCalculationError : virtual boost::exception, virtual std::exception{ };
+
+/**
+ * @brief Will be thrown when data cannot be properly decoded to SyncStateMsg
+ */
+struct SyncStateMsgDecodingFailure : virtual boost::exception, virtual std::exception{ };
+}
+
 /**
  * @ingroup sync
- * @brief A simple wrapper for libcrypto hash functions
+ * @brief A finalized SHA-256 digest stored inline
+ *
+ * DigestValue is trivially copyable and is meant to be passed and stored by value.
+ * A default constructed value is the zero digest.
  */
-class Digest
+class DigestValue
 {
+public:
+  static const std::size_t SIZE = 32;
+
 public:
   /**
-   * @brief Will be thrown when data cannot be properly decoded to SyncStateMsg
+   * @brief Construct a zero digest
    */
-  struct SyncStateMsgDecodingFailure : virtual boost::exception, virtual std::exception{ };
+  DigestValue();
 
-public:
   /**
-   * @brief Default constructor.  Will initialize internal libssl structures
+   * @brief Construct a digest from SIZE raw bytes
    */
-  Digest();
+  explicit
+  DigestValue(const uint8_t *buffer);
 
   /**
-   * @brief Check if digest is empty
+   * @brief Checks if the stored hash is zero-root hash
+   *
+   * Zero-root hash is a valid hash that optimally represents an empty state
    */
   bool
-  empty() const;
+  isZero() const;
 
   /**
-   * @brief Reset digest to the initial state
+   * @brief Obtain a short version of the hash (just first sizeof(size_t) bytes)
    */
-  void
-  reset();
+  std::size_t
+  getHash() const;
+
+  const uint8_t *
+  data() const
+  {
+    return m_buffer;
+  }
+
+  std::size_t
+  size() const
+  {
+    return SIZE;
+  }
+
+  bool
+  operator == (const DigestValue &digest) const;
+
+  bool
+  operator != (const DigestValue &digest) const
+  { return !(*this == digest); }
+
+  bool
+  operator < (const DigestValue &digest) const;
 
   /**
-   * @brief Destructor
+   * @brief Add another digest, treating both as 256-bit big-endian integers (mod 2^256)
+   *
+   * Addition is commutative, so a sum of digests does not depend on the order of terms
    */
-  ~Digest();
+  DigestValue &
+  operator += (const DigestValue &digest);
 
   /**
-   * @brief Obtain a short version of the hash (just first sizeof(size_t) bytes
-   *
-   * Side effect: finalize() will be called on `this'
+   * @brief Subtract another digest (mod 2^256), the inverse of operator +=
    */
-  std::size_t
-  getHash() const;
+  DigestValue &
+  operator -= (const DigestValue &digest);
 
+private:
+  friend std::istream &
+  operator >> (std::istream &is, DigestValue &digest);
+
+private:
+  uint8_t m_buffer[SIZE];
+};
+
+/**
+ * @ingroup sync
+ * @brief Streaming SHA-256 calculation producing a DigestValue
+ *
+ * The libcrypto context is borrowed from a shared pool for the lifetime of the builder
+ * and returned on destruction, so building a digest does not allocate a new context.
+ */
+class DigestBuilder : noncopyable
+{
+public:
   /**
-   * @brief Finalize digest. All subsequent calls to "operator <<" will fire an exception
+   * @brief Borrow a context and initialize it
    */
-  void
-  finalize();
+  DigestBuilder();
 
   /**
-   * @brief Compare two full digests
-   *
-   * Side effect: Finalize will be called on `this' and `digest'
+   * @brief Return the context to the pool
    */
-  bool
-  operator == (const Digest &digest) const;
+  ~DigestBuilder();
 
-  bool
-  operator != (const Digest &digest) const
-  { return !(*this == digest); }
+  /**
+   * @brief Reset the builder to the initial state
+   */
+  void
+  reset();
 
+  /**
+   * @brief Finalize the calculation. The builder must be reset before it is used again
+   */
+  DigestValue
+  finalize();
 
   /**
    * @brief Add existing digest to digest calculation
@@ -101,94 +162,54 @@ public:
    *
    * The result of this combination is  hash (hash (...))
    */
-  Digest &
-  operator << (const Digest &src);
+  DigestBuilder &
+  operator << (const DigestValue &src);
 
   /**
    * @brief Add string to digest calculation
    * @param str string to put into digest
    */
-  inline Digest &
+  inline DigestBuilder &
   operator << (const std::string &str);
 
   /**
    * @brief Add uint64_t value to digest calculation
    * @param value uint64_t value to put into digest
    */
-  Digest &
+  DigestBuilder &
   operator << (uint64_t value);
 
-  /**
-   * @brief Checks if the stored hash is zero-root hash
-   *
-   * Zero-root hash is a valid hash that optimally represents an empty state
-   */
-  bool
-  isZero() const;
-
 private:
-  Digest &
-  operator = (Digest &digest)
-  {
-    (void)digest;
-    return *this;
-  }
-
   /**
    * @brief Add size bytes of buffer to the hash
    */
   void
   update(const uint8_t *buffer, size_t size);
 
-  friend std::ostream &
-  operator << (std::ostream &os, const Digest &digest);
-
-  friend std::istream &
-  operator >> (std::istream &is, Digest &digest);
-
 private:
   EVP_MD_CTX *m_context;
-  std::vector<uint8_t> m_buffer;
+  bool m_finalized;
 };
 
-namespace Error {
-struct DigestCalculationError : virtual boost::exception, virtual std::exception{ };
-}
-
-typedef boost::shared_ptr<Digest> DigestPtr;
-typedef boost::shared_ptr<const Digest> DigestConstPtr;
-
-Digest &
-Digest::operator << (const std::string &str)
+DigestBuilder &
+DigestBuilder::operator << (const std::string &str)
 {
   update (reinterpret_cast<const uint8_t*> (str.c_str()), str.size());
   return *this;
 }
 
 std::ostream &
-operator << (std::ostream &os, const Digest &digest);
+operator << (std::ostream &os, const DigestValue &digest);
 
 std::istream &
-operator >> (std::istream &is, Digest &digest);
+operator >> (std::istream &is, DigestValue &digest);
 
-struct DigestPtrHash : public std::unary_function<Digest, std::size_t>
+struct DigestValueHash : public std::unary_function<DigestValue, std::size_t>
 {
   std::size_t
-  operator() (DigestConstPtr digest) const
-  {
-    // std::cout << "digest->getHash: " << digest->getHash () << " (" << *digest << ")" << std::endl;
-    return digest->getHash();
-  }
-};
-
-struct DigestPtrEqual : public std::unary_function<Digest, std::size_t>
-{
-  bool
-  operator() (DigestConstPtr digest1, DigestConstPtr digest2) const
+  operator() (const DigestValue &digest) const
   {
-    // std::cout << boost::cref(*digest1) << " == " << boost::cref(*digest2)
-    // << " : " << (*digest1 == *digest2) << std::endl;
-    return *digest1 == *digest2;
+    return digest.getHash();
   }
 };
 
@@ -40,7 +40,7 @@ namespace ndn {
 
 struct InterestEntry
 {
-  InterestEntry (DigestConstPtr digest, const std::string &name, bool unknown=false)
+  InterestEntry (const DigestValue &digest, const std::string &name, bool unknown=false)
   : m_digest (digest)
   , m_name (name)
   , m_time (TIME_NOW)
@@ -48,7 +48,7 @@ struct InterestEntry
   {
   }
   
-  DigestConstPtr m_digest;
+  DigestValue    m_digest;
   std::string    m_name;
   TimeAbsolute   m_time;
   bool           m_unknown;
@@ -75,9 +75,8 @@ struct InterestContainer : public mi::multi_index_container<
     
     mi::hashed_non_unique<
       mi::tag<hashed>,
-      BOOST_MULTI_INDEX_MEMBER(InterestEntry, DigestConstPtr, m_digest),
-      DigestPtrHash,
-      DigestPtrEqual
+      BOOST_MULTI_INDEX_MEMBER(InterestEntry, DigestValue, m_digest),
+      DigestValueHash
       >
     ,
     
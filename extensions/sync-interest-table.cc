@@ -67,7 +67,7 @@ SyncInterestTable::begin()
 }
 
 bool
-SyncInterestTable::insert (DigestConstPtr digest, const string &name, bool unknownState/*=false*/)
+SyncInterestTable::insert (const DigestValue &digest, const string &name, bool unknownState/*=false*/)
 {
   bool existent = false;
   
@@ -106,7 +106,7 @@ SyncInterestTable::remove (const string &name)
 }
 
 bool
-SyncInterestTable::remove (DigestConstPtr digest)
+SyncInterestTable::remove (const DigestValue &digest)
 {
   recursive_mutex::scoped_lock lock (m_mutex);
   InterestContainer::index<hashed>::type::iterator item = m_table.get<hashed> ().find (digest);
@@ -50,13 +50,13 @@ public:
    * timestamp
    */
   bool
-  insert (DigestConstPtr interest, const std::string &name, bool unknownState=false);
+  insert (const DigestValue &interest, const std::string &name, bool unknownState=false);
 
   /**
    * @brief Remove interest by digest (e.g., when it was satisfied)
    */
   bool
-  remove (DigestConstPtr interest);
+  remove (const DigestValue &interest);
 
   /**
    * @brief Remove interest by name (e.g., when it was satisfied)
@@ -20,20 +20,161 @@
 
 #include "sync-msg.hpp"
 
+#include <boost/unordered_map.hpp>
+#include <google/protobuf/io/coded_stream.h>
+
 namespace ns3 {
 namespace ndn {
 
 using namespace Sync;
-Msg::Msg(SyncStateMsg_MsgType type)
+
+static void
+appendVarint(std::string& buffer, uint64_t value)
+{
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+static uint64_t
+readVarint(const std::string& buffer, size_t& position)
+{
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (position >= buffer.size())
+      throw Msg::Error("Truncated varint in the received snapshot");
+    uint8_t byte = static_cast<uint8_t>(buffer[position++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  throw Msg::Error("Malformed varint in the received snapshot");
+}
+
+namespace {
+
+/**
+ * @brief  lowest and highest sequence number announced for every creator, kept in the order
+ *         the creators first appear
+ */
+class SeqRanges
+{
+public:
+  void
+  add(CreatorId creator, uint64_t first, uint64_t last)
+  {
+    std::pair<boost::unordered_map<CreatorId, size_t>::iterator, bool> inserted =
+      m_index.insert(std::make_pair(creator, m_ranges.size()));
+    if (inserted.second) {
+      Range range = {creator, first, last};
+      m_ranges.push_back(range);
+      return;
+    }
+    Range& range = m_ranges[inserted.first->second];
+    range.first = std::min(range.first, first);
+    range.last = std::max(range.last, last);
+  }
+
+  void
+  apply(const boost::function< void (CreatorId, const uint64_t &, const uint64_t &) >& f) const
+  {
+    for (std::vector<Range>::const_iterator it = m_ranges.begin(); it != m_ranges.end(); ++it)
+      f(it->creator, it->first, it->last);
+  }
+
+private:
+  struct Range
+  {
+    CreatorId creator;
+    uint64_t first;
+    uint64_t last;
+  };
+
+  std::vector<Range> m_ranges;
+  boost::unordered_map<CreatorId, size_t> m_index;
+};
+
+} // namespace
+
+Msg::Encoding
+Msg::strToEncoding(const std::string& encoding)
+{
+  if (encoding == "plain")
+    return PLAIN;
+  else if (encoding == "compact")
+    return COMPACT;
+  else
+    throw Error("Unknown message encoding: " + encoding);
+}
+
+Msg::Msg(SyncStateMsg_MsgType type, Encoding encoding)
   : m_type(type)
+  , m_encoding(encoding)
+  , m_hasLastDataName(true)
+  , m_dataSize(0)
+  , m_hasWire(false)
 {
   m_msg.set_type(m_type);
+  if (m_encoding != PLAIN)
+    m_msg.set_encoding(m_encoding);
 }
 
 Msg::Msg(const SyncStateMsg& msg)
   : m_msg(msg)
   , m_type(m_msg.type())
+  , m_encoding(static_cast<Encoding>(m_msg.encoding()))
+  , m_hasLastDataName(false)
+  , m_dataSize(0)
+  , m_hasWire(false)
+{
+}
+
+void
+Msg::swap(Msg& other)
+{
+  m_msg.Swap(&other.m_msg);
+  std::swap(m_type, other.m_type);
+  std::swap(m_encoding, other.m_encoding);
+  m_creatorIndex.swap(other.m_creatorIndex);
+  m_lastSeq.swap(other.m_lastSeq);
+  m_lastDataName.swap(other.m_lastDataName);
+  std::swap(m_hasLastDataName, other.m_hasLastDataName);
+  std::swap(m_dataSize, other.m_dataSize);
+  m_wire.swap(other.m_wire);
+  std::swap(m_hasWire, other.m_hasWire);
+}
+
+bool
+Msg::parseFrom(const char* wire, size_t len)
+{
+  bool isValid = m_msg.ParseFromArray(wire, len) && m_msg.IsInitialized();
+  reset();
+  return isValid;
+}
+
+void
+Msg::reset()
+{
+  m_type = m_msg.type();
+  m_encoding = static_cast<Encoding>(m_msg.encoding());
+  m_creatorIndex.clear();
+  m_lastSeq.clear();
+  m_hasLastDataName = false;
+  m_dataSize = 0;
+  invalidate();
+}
+
+const std::string&
+Msg::getWire() const
 {
+  if (!m_hasWire)
+  {
+    m_msg.SerializeToString(&m_wire);
+    m_hasWire = true;
+  }
+  return m_wire;
 }
 
 // The process can be simplified later by only write actionName into the message,
@@ -42,6 +183,27 @@ void
 Msg::writeActionNameToMsg(const ActionEntry& action)
 {
   BOOST_ASSERT(m_type == SyncStateMsg::ACTION);
+  invalidate();
+  if (m_encoding == COMPACT)
+  {
+    // extend the last run if the action follows it, otherwise start a new run
+    uint32_t creator = getCreatorIndex(action);
+    uint64_t& lastSeq = m_lastSeq[creator];
+    int n = m_msg.run_size();
+    if (n > 0 && m_msg.run(n - 1).creator() == creator && action.getSeqNo() == lastSeq + 1)
+    {
+      SyncActionRun *run = m_msg.mutable_run(n - 1);
+      run->set_count(run->count() + 1);
+    }
+    else
+    {
+      SyncActionRun *run = m_msg.add_run();
+      run->set_creator(creator);
+      run->set_seqdelta(static_cast<int64_t>(action.getSeqNo() - lastSeq));
+    }
+    lastSeq = action.getSeqNo();
+    return;
+  }
   SyncState *oss = m_msg.add_ss();
   oss->set_name(action.getCreatorName().toUri());
   oss->set_seq(action.getSeqNo());
@@ -53,8 +215,17 @@ void
 Msg::writeActionToMsg(const ActionEntry& action)
 {
   BOOST_ASSERT(m_type == SyncStateMsg::ACTION);
+  invalidate();
   SyncState *oss = m_msg.add_ss();
-  oss->set_name(action.getCreatorName().toUri());
+  if (m_encoding == COMPACT)
+  {
+    oss->set_name("");
+    oss->set_creator(getCreatorIndex(action));
+  }
+  else
+  {
+    oss->set_name(action.getCreatorName().toUri());
+  }
   oss->set_seq(action.getSeqNo());
   if (action.getAction() == DELETION)
   {
@@ -69,10 +240,75 @@ Msg::writeActionToMsg(const ActionEntry& action)
   //std::cout<<"^^^^^^^^^^^^^ write action to msg name = "<<action.getCreatorName()<<"  seq = "<<action.getSeqNo()<<std::endl;
 }
 
+bool
+Msg::writeActionToMsg(const ActionEntry& action, size_t& budget)
+{
+  BOOST_ASSERT(m_type == SyncStateMsg::ACTION);
+  if (budget > 0 && (action.getAction() == INSERTION || action.getAction() == DELETION))
+  {
+    writeActionToMsg(action);
+    int size = m_msg.ss(m_msg.ss_size() - 1).ByteSize();
+    // the entry also costs its field tag and length prefix
+    size_t encoded = size + 1 + google::protobuf::io::CodedOutputStream::VarintSize32(size);
+    if (encoded <= budget)
+    {
+      budget -= encoded;
+      return true;
+    }
+    m_msg.mutable_ss()->RemoveLast();
+  }
+  budget = 0;
+  writeActionNameToMsg(action);
+  return false;
+}
+
 void
 Msg::writeDataToSnapshot(const Name& name, const status & stat)
 {
   BOOST_ASSERT(m_type == SyncStateMsg::SNAPSHOT);
+  invalidate();
+  if (m_encoding == COMPACT)
+  {
+    uint32_t bits;
+    switch (stat) {
+      case EXISTED:
+        bits = 0;
+        break;
+      case DELETED:
+        bits = 1;
+        break;
+      case INSERTED:
+        bits = 2;
+        break;
+      default:
+        throw Error("Data status is not correct");
+    }
+
+    // front coding against the previous name
+    std::string uri = name.toUri();
+    if (!m_hasLastDataName) {
+      m_lastDataName = readDataNames(boost::function< void (const Name &, const status &) >());
+      m_hasLastDataName = true;
+    }
+    size_t shared = 0;
+    size_t length = std::min(uri.size(), m_lastDataName.size());
+    while (shared < length && uri[shared] == m_lastDataName[shared])
+      shared++;
+    std::string* names = m_msg.mutable_datanames();
+    appendVarint(*names, shared);
+    appendVarint(*names, uri.size() - shared);
+    names->append(uri, shared, std::string::npos);
+    m_lastDataName.swap(uri);
+
+    uint32_t index = m_msg.datacount();
+    std::string* stats = m_msg.mutable_datastatus();
+    if (index % 4 == 0)
+      stats->push_back(0);
+    (*stats)[index / 4] = static_cast<char>((*stats)[index / 4] | (bits << (2 * (index % 4))));
+    m_msg.set_datacount(index + 1);
+    m_dataSize = names->size() + stats->size();
+    return;
+  }
   SyncData *oss = m_msg.add_data();
   oss->set_dataname(name.toUri());
   switch (stat) {
@@ -89,6 +325,8 @@ Msg::writeDataToSnapshot(const Name& name, const status & stat)
       throw Error("Data status is not correct");
       break;
     }
+  // the name and status fields and the tag and length of the entry
+  m_dataSize += oss->ByteSize() + 3;
 
 }
 
@@ -96,6 +334,7 @@ void
 Msg::writeTreeToSnapshot(const Name& name, const uint64_t seq)
 {
   BOOST_ASSERT(m_type == SyncStateMsg::SNAPSHOT);
+  invalidate();
   SyncTreeNode *oss = m_msg.add_node();
   oss->set_creatorname(name.toUri());
   oss->set_seq(seq);
@@ -105,6 +344,7 @@ void
 Msg::writeInfoToSnapshot(const Name& name, const uint64_t version)
 {
   BOOST_ASSERT(m_type == SyncStateMsg::SNAPSHOT);
+  invalidate();
   m_msg.set_name(name.toUri());
   m_msg.set_version(version);
 }
@@ -113,6 +353,8 @@ void
 Msg::readDataFromSnapshot(boost::function< void (const Name &, const status&) > f)
 {
   BOOST_ASSERT(m_msg.type() == SyncStateMsg::SNAPSHOT);
+  if (m_msg.has_datacount())
+    readDataNames(f);
   int n = m_msg.data_size();
   for (int i = 0; i < n; i++)
   {
@@ -172,15 +414,62 @@ Msg::readInfoFromSnapshot()
 }
 
 void
-Msg::readActionNameFromMsg(boost::function< void (const Name &, const uint64_t &, const uint64_t &) > f, const Name& name)
+Msg::writeSegmentToSnapshot(const uint64_t segment, const uint64_t finalSegment)
+{
+  BOOST_ASSERT(m_type == SyncStateMsg::SNAPSHOT);
+  BOOST_ASSERT(segment <= finalSegment);
+  invalidate();
+  m_msg.set_segment(segment);
+  m_msg.set_finalsegment(finalSegment);
+}
+
+std::pair<uint64_t, uint64_t>
+Msg::readSegmentFromSnapshot() const
+{
+  BOOST_ASSERT(m_msg.type() == SyncStateMsg::SNAPSHOT);
+  if (m_msg.segment() > m_msg.finalsegment()) {
+    throw Error("Segment number is beyond the final segment in the received snapshot");
+  }
+  return std::make_pair(m_msg.segment(), m_msg.finalsegment());
+}
+
+void
+Msg::writeDeltaToSnapshot(const uint64_t base, const uint64_t finalSegment)
+{
+  BOOST_ASSERT(m_type == SyncStateMsg::SNAPSHOT);
+  invalidate();
+  SnapshotDelta* delta = m_msg.add_delta();
+  delta->set_base(base);
+  delta->set_finalsegment(finalSegment);
+}
+
+bool
+Msg::readDeltaFromSnapshot(const uint64_t base, uint64_t& finalSegment) const
+{
+  BOOST_ASSERT(m_msg.type() == SyncStateMsg::SNAPSHOT);
+  for (int i = 0; i < m_msg.delta_size(); i++)
+  {
+    if (m_msg.delta(i).base() == base) {
+      finalSegment = m_msg.delta(i).finalsegment();
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+Msg::readActionNameFromMsg(boost::function< void (CreatorId, const uint64_t &, const uint64_t &) > f, const Name& name)
 {
   BOOST_ASSERT(m_msg.type() == SyncStateMsg::ACTION);
+  CreatorTable& creators = CreatorTable::getInstance();
+  CreatorId self = creators.intern(name);
+  SeqRanges ranges;
   int n = m_msg.ss_size();
-  std::map<Name, uint64_t> finalSeq;
-  std::list<std::pair<Name, uint64_t> > actionList;
   for (int i = 0; i < n; i++)
   {
     const SyncState &ss = m_msg.ss(i);
+    if (ss.has_dataname())
+      continue;
     if (!ss.has_name()) {
       throw Error("Cannot read creator name from the received action name");
     }
@@ -189,30 +478,148 @@ Msg::readActionNameFromMsg(boost::function< void (const Name &, const uint64_t &
       throw Error("Cannot read sequence number from the received action name");
     }
 
-    Name creator(ss.name());
-    if (creator == name)
+    CreatorId creator = creators.intern(ss.name());
+    if (creator == self)
       continue;
-    uint64_t seq = boost::lexical_cast<uint64_t>(ss.seq());
-    if (seq > finalSeq[creator]) {
-      finalSeq[creator] = seq;
-    }
-    actionList.push_back(std::make_pair(creator, seq));
+    ranges.add(creator, ss.seq(), ss.seq());
   }
-  for (std::list<std::pair<Name, uint64_t> >::iterator it = actionList.begin(); it != actionList.end(); it++)
+
+  // a compact message carries the action names as runs
+  std::vector<CreatorId> dictionary = readCreators();
+  std::vector<uint64_t> lastSeq(dictionary.size(), 0);
+  n = m_msg.run_size();
+  for (int i = 0; i < n; i++)
   {
-    f(it->first, it->second, finalSeq[it->first]);
+    const SyncActionRun &run = m_msg.run(i);
+    if (run.creator() >= dictionary.size()) {
+      throw Error("Cannot find the creator of the received action run");
+    }
+    uint64_t first = lastSeq[run.creator()] + run.seqdelta();
+    uint64_t last = first + run.count() - 1;
+    if (run.count() == 0 || first < lastSeq[run.creator()] || last < first) {
+      throw Error("Cannot read the sequence numbers of the received action run");
+    }
+    lastSeq[run.creator()] = last;
+
+    CreatorId creator = dictionary[run.creator()];
+    if (creator == self)
+      continue;
+    ranges.add(creator, first, last);
   }
-  
+
+  ranges.apply(f);
 }
 
-// read from fetch data, one data only has one aciton
-void
+// read from fetch data, a range fetch is answered with several actions
+size_t
 Msg::readActionFromMsg(boost::function< void (const ActionEntry & ) > f)
 {
   BOOST_ASSERT(m_msg.type() == SyncStateMsg::ACTION);
-  BOOST_ASSERT(m_msg.ss_size() == 1);
-  const SyncState &ss = m_msg.ss(0);
+  std::vector<CreatorId> dictionary = readCreators();
+  int n = m_msg.ss_size();
+  for (int i = 0; i < n; i++)
+  {
+    f(decodeAction(m_msg.ss(i), dictionary));
+  }
+  return n;
+}
+
+size_t
+Msg::readEmbeddedActionFromMsg(boost::function< void (const ActionEntry &) > f, const Name& name)
+{
+  BOOST_ASSERT(m_msg.type() == SyncStateMsg::ACTION);
+  int n = m_msg.ss_size();
+  CreatorId self = CreatorTable::getInstance().intern(name);
+  std::vector<CreatorId> dictionary = readCreators();
+  size_t count = 0;
+  for (int i = 0; i < n; i++)
+  {
+    const SyncState &ss = m_msg.ss(i);
+    if (!ss.has_dataname())
+      continue;
+    ActionEntry entry = decodeAction(ss, dictionary);
+    count++;
+    if (entry.getCreatorId() == self)
+      continue;
+    f(entry);
+  }
+  return count;
+}
+
+std::string
+Msg::readDataNames(const boost::function< void (const Name &, const status &) >& f) const
+{
+  const std::string& names = m_msg.datanames();
+  const std::string& stats = m_msg.datastatus();
+  uint32_t n = m_msg.datacount();
+  if (stats.size() < (n + 3) / 4) {
+    throw Error("Cannot read status from the received snapshot");
+  }
 
+  std::string uri;
+  size_t position = 0;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    uint64_t shared = readVarint(names, position);
+    uint64_t length = readVarint(names, position);
+    if (shared > uri.size() || length > names.size() - position) {
+      throw Error("Cannot read data name from the received snapshot");
+    }
+    uri.replace(shared, std::string::npos, names, position, length);
+    position += length;
+    if (f.empty())
+      continue;
+
+    uint32_t bits = (static_cast<uint8_t>(stats[i / 4]) >> (2 * (i % 4))) & 3;
+    status stat;
+    if (bits == 0)
+    {
+      stat = EXISTED;
+    }
+    else if (bits == 1)
+    {
+      stat = DELETED;
+    }
+    else if (bits == 2)
+    {
+      stat = INSERTED;
+    }
+    else
+    {
+      throw Error("Data status is not correct in the received snapshot");
+    }
+    f(Name(uri), stat);
+  }
+  return uri;
+}
+
+uint32_t
+Msg::getCreatorIndex(const ActionEntry& action)
+{
+  boost::unordered_map<CreatorId, uint32_t>::iterator it = m_creatorIndex.find(action.getCreatorId());
+  if (it != m_creatorIndex.end())
+    return it->second;
+
+  uint32_t index = static_cast<uint32_t>(m_msg.creator_size());
+  m_msg.add_creator(action.getCreatorName().toUri());
+  m_creatorIndex[action.getCreatorId()] = index;
+  m_lastSeq.push_back(0);
+  return index;
+}
+
+std::vector<CreatorId>
+Msg::readCreators() const
+{
+  std::vector<CreatorId> creators;
+  creators.reserve(m_msg.creator_size());
+  for (int i = 0; i < m_msg.creator_size(); i++)
+    creators.push_back(CreatorTable::getInstance().intern(m_msg.creator(i)));
+  return creators;
+}
+
+ActionEntry
+Msg::decodeAction(const SyncState& ss, const std::vector<CreatorId>& creators) const
+{
   if (!ss.has_name()) {
     throw Error("Cannot read creator name from the received action");
   }
@@ -247,11 +654,41 @@ Msg::readActionFromMsg(boost::function< void (const ActionEntry & ) > f)
   {
     throw Error("Cannot support such action type!");
   }
- 
+
   uint64_t version = boost::lexical_cast<uint64_t>(ss.version());
-  ActionEntry entry(Name(ss.name()), seq, action, Name(ss.dataname()), version);
   // std::cout<<"readActionFromMesg name = "<<entry.getName()<<std::endl;
-  f(entry);
+  if (ss.has_creator())
+  {
+    if (ss.creator() >= creators.size()) {
+      throw Error("Cannot find the creator of the received action");
+    }
+    const Name& creator = CreatorTable::getInstance().getName(creators[ss.creator()]);
+    return ActionEntry(creator, seq, action, Name(ss.dataname()), version);
+  }
+  return ActionEntry(Name(ss.name()), seq, action, Name(ss.dataname()), version);
+}
+
+MsgPool::Lease::Lease(MsgPool& pool)
+  : m_pool(pool)
+{
+  if (m_pool.m_free.empty()) {
+    m_msg = new Msg(SyncStateMsg::ACTION);
+  }
+  else {
+    m_msg = m_pool.m_free.back();
+    m_pool.m_free.pop_back();
+  }
+}
+
+MsgPool::Lease::~Lease()
+{
+  m_pool.m_free.push_back(m_msg);
+}
+
+MsgPool::~MsgPool()
+{
+  for (std::vector<Msg*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
 }
 
 }
@@ -25,6 +25,8 @@
 #include "action-entry.hpp"
 #include "sync-state.pb.h"
 
+#include <boost/unordered_map.hpp>
+
 namespace ns3 {
 namespace ndn {
 
@@ -42,13 +44,32 @@ public:
     }
   };
 
+  /**
+   * @brief  how action names are encoded
+   *
+   * PLAIN writes every action as a SyncState carrying the creator name.  COMPACT lists each
+   * creator once and writes action names as runs of consecutive sequence numbers, encoded
+   * as deltas, that refer to the creator by index; whole actions refer to it the same way.
+   * The data names of a COMPACT snapshot are front coded, with their status packed in two
+   * bits each.  The encoding is recorded in the message, so either one can be read.
+   */
+  enum Encoding
+  {
+    PLAIN = 0,
+    COMPACT = 1
+  };
+
+  static Encoding
+  strToEncoding(const std::string& encoding);
+
 public:
-  Msg(SyncStateMsg_MsgType type);
+  explicit
+  Msg(SyncStateMsg_MsgType type, Encoding encoding = PLAIN);
 
   explicit
   Msg(const SyncStateMsg& msg);
 
-  SyncStateMsg
+  const SyncStateMsg&
   getMsg() const
   {
     return m_msg;
@@ -58,8 +79,37 @@ public:
   setMsg(const SyncStateMsg& msg)
   {
     m_msg = msg;
+    reset();
+  }
+
+  /**
+   * @brief  replace the content with the message decoded from 'wire'
+   *
+   * The memory held for the repeated fields and strings of the previous content is reused,
+   * so decoding into the same message again only allocates where the new content is larger.
+   * @return false if 'wire' is not a valid message
+   */
+  bool
+  parseFrom(const char* wire, size_t len);
+
+  Encoding
+  getEncoding() const
+  {
+    return m_encoding;
   }
 
+  /**
+   * @brief  exchange the content with another message, e.g. to install a new snapshot without copying it
+   */
+  void
+  swap(Msg& other);
+
+  /**
+   * @brief  the serialized message; it is encoded on the first call and cached until the message changes
+   */
+  const std::string&
+  getWire() const;
+
   /**
    * @brief  write multiple action names, including creator name and seqNo, into data
    */
@@ -72,6 +122,16 @@ public:
   void
   writeActionToMsg(const ActionEntry& action);
 
+  /**
+   * @brief  write one action into data if its encoding fits in the budget, otherwise only its name
+   *
+   * The budget is reduced by the encoded size of the action.  Once an action does not fit the
+   * budget drops to 0, so the whole actions of a message always precede the action names.
+   * @return true if the whole action has been written
+   */
+  bool
+  writeActionToMsg(const ActionEntry& action, size_t& budget);
+
   void
   writeDataToSnapshot(const Name& name, const status & stat);
 
@@ -91,20 +151,155 @@ public:
   readInfoFromSnapshot();
 
   /**
-   * @brief  read multiple action names from the received data, and call the function to handle the action names
+   * @brief  number the snapshot as segment 'segment' of a snapshot made of segments 0 to 'finalSegment'
    */
   void
-  readActionNameFromMsg(boost::function< void (const Name &, const uint64_t &, const uint64_t &) > f, const Name& name);
+  writeSegmentToSnapshot(const uint64_t segment, const uint64_t finalSegment);
+
+  /**
+   * @brief  the segment number and the final segment number of the snapshot,
+   *         a snapshot that is not segmented is segment 0 of 0
+   */
+  std::pair<uint64_t, uint64_t>
+  readSegmentFromSnapshot() const;
 
   /**
-   * @brief  read the entire action from received data, and call the function to handle the action
+   * @brief  announce that the changes since snapshot 'base' are published as segments 0 to 'finalSegment'
    */
   void
+  writeDeltaToSnapshot(const uint64_t base, const uint64_t finalSegment);
+
+  /**
+   * @brief  look up the changes since snapshot 'base' announced by the snapshot
+   * @return false if they are not announced
+   */
+  bool
+  readDeltaFromSnapshot(const uint64_t base, uint64_t& finalSegment) const;
+
+  /**
+   * @brief  approximate encoded size of the data written to the snapshot by writeDataToSnapshot,
+   *         used to cut a snapshot in segments
+   */
+  size_t
+  getDataSize() const
+  {
+    return m_dataSize;
+  }
+
+  /**
+   * @brief  read multiple action names from the received data, and call the function once for
+   *         every creator other than 'name' with the lowest and the highest sequence number
+   *         announced for it, in the order the creators first appear
+   *
+   * Whole actions in the data are skipped, they are read by readEmbeddedActionFromMsg.
+   */
+  void
+  readActionNameFromMsg(boost::function< void (CreatorId, const uint64_t &, const uint64_t &) > f, const Name& name);
+
+  /**
+   * @brief  read the entire actions from received data, and call the function to handle each
+   *         action in the order they are written
+   * @return the number of actions read
+   */
+  size_t
   readActionFromMsg(boost::function< void (const ActionEntry &) > f);
 
+  /**
+   * @brief  read the whole actions embedded in a sync reply, except the ones created by 'name',
+   *         and call the function to handle each action in the order they are written
+   * @return the number of actions read
+   */
+  size_t
+  readEmbeddedActionFromMsg(boost::function< void (const ActionEntry &) > f, const Name& name);
+
+private:
+  ActionEntry
+  decodeAction(const SyncState& ss, const std::vector<CreatorId>& creators) const;
+
+  /**
+   * @brief  index of the creator of the action in the creator dictionary, added if missing
+   */
+  uint32_t
+  getCreatorIndex(const ActionEntry& action);
+
+  /**
+   * @brief  intern the creators of the creator dictionary
+   */
+  std::vector<CreatorId>
+  readCreators() const;
+
+  /**
+   * @brief  decode the front coded data names one at a time, calling f for each of them
+   *         unless f is empty
+   * @return the last data name
+   */
+  std::string
+  readDataNames(const boost::function< void (const Name &, const status &) >& f) const;
+
+private:
+  /**
+   * @brief  derive the encoding state from a message that has been replaced
+   */
+  void
+  reset();
+
+  void
+  invalidate()
+  {
+    m_hasWire = false;
+  }
+
 private:
   SyncStateMsg m_msg;
   SyncStateMsg_MsgType m_type;
+  Encoding m_encoding;
+  boost::unordered_map<CreatorId, uint32_t> m_creatorIndex;  // creator to dictionary index
+  std::vector<uint64_t> m_lastSeq;                            // last seq written per dictionary index
+  std::string m_lastDataName;                                 // reference of the next front coded name
+  bool m_hasLastDataName;
+  size_t m_dataSize;
+  mutable std::string m_wire;
+  mutable bool m_hasWire;
+};
+
+/**
+ * @brief  messages to decode received data into, reused from one data packet to the next
+ *
+ * A message is leased while the data is processed.  Data delivered in the meantime, e.g. by a
+ * content store answering an interest sent during the processing, leases another message.
+ */
+class MsgPool : noncopyable
+{
+public:
+  class Lease : noncopyable
+  {
+  public:
+    explicit
+    Lease(MsgPool& pool);
+
+    ~Lease();
+
+    Msg&
+    operator*() const
+    {
+      return *m_msg;
+    }
+
+    Msg*
+    operator->() const
+    {
+      return m_msg;
+    }
+
+  private:
+    MsgPool& m_pool;
+    Msg* m_msg;
+  };
+
+  ~MsgPool();
+
+private:
+  std::vector<Msg*> m_free;
 };
 
 }
@@ -35,59 +35,133 @@ namespace ns3 {
 namespace ndn {
 
 Scheduler::Scheduler ()
+  : m_tick (0)
 {
 }
 
 Scheduler::~Scheduler ()
 {
+  while (!m_labeledEvents.empty ())
+    cancel (m_labeledEvents.begin ()->first);
+
+  for (boost::unordered_map<int64_t, Tick>::iterator it = m_ticks.begin (); it != m_ticks.end (); ++it)
+    {
+      Simulator::Remove (it->second.eventId);
+      for (vector<Entry*>::iterator entry = it->second.entries.begin (); entry != it->second.entries.end (); ++entry)
+        delete *entry;
+    }
 }
 
 void
-Scheduler::eventWrapper (Event event)
+Scheduler::setTick (const TimeDuration &tick)
 {
-  event ();
+  m_tick = tick.GetNanoSeconds ();
 }
 
 void
 Scheduler::schedule (const TimeDuration &reltime, Event event, uint32_t label)
 {
   //_LOG_DEBUG ("Schedule event for " << (Simulator::Now () +reltime).ToDouble (Time::S) << "s for label " << label);
-  
-  list< EventId > &eventsForLabel = m_labeledEvents [label];
-  list< EventId >::iterator i = eventsForLabel.begin ();
-  while (i != eventsForLabel.end ())
+
+  Entry *entry = new Entry;
+  entry->event.swap (event);
+  entry->label = label;
+  entry->prev = 0;
+
+  Entry *&first = m_labeledEvents [label];
+  entry->next = first;
+  if (first != 0)
+    first->prev = entry;
+  first = entry;
+
+  if (m_tick == 0)
     {
-      if (i->IsExpired ())
-        {
-          list< EventId >::iterator next = i;
-          next ++;
-          eventsForLabel.erase (i);
-          i = next;
-        }
-      else
-        i ++;
+      entry->eventId = Simulator::Schedule (reltime, &Scheduler::fire, this, entry);
+      return;
     }
 
-  ns3::EventId eventId = ns3::Simulator::Schedule (reltime, Scheduler::eventWrapper, event);
-  eventsForLabel.push_back (eventId);
+  int64_t time = (Simulator::Now () + reltime).GetNanoSeconds ();
+  int64_t tick = (time + m_tick - 1) / m_tick;
+  Tick &events = m_ticks [tick];
+  if (events.entries.empty ())
+    events.eventId = Simulator::Schedule (NanoSeconds (tick * m_tick) - Simulator::Now (),
+                                          &Scheduler::fireTick, this, tick);
+  events.entries.push_back (entry);
 }
 
 void
 Scheduler::cancel (uint32_t label)
 {
-  list< EventId > &eventsForLabel = m_labeledEvents [label];
-  //_LOG_DEBUG ("Canceling events for label " << label << " (" << eventsForLabel.size () << " events)");
+  boost::unordered_map<uint32_t, Entry*>::iterator it = m_labeledEvents.find (label);
+  if (it == m_labeledEvents.end ())
+    return;
+
+  Entry *entry = it->second;
+  m_labeledEvents.erase (it);
+  //_LOG_DEBUG ("Canceling events for label " << label);
 
-  for (list< EventId >::iterator i = eventsForLabel.begin ();
-       i != eventsForLabel.end ();
-       i++)
+  while (entry != 0)
     {
-      Simulator::Remove (*i);
+      Entry *next = entry->next;
+      if (m_tick == 0)
+        {
+          Simulator::Remove (entry->eventId);
+          delete entry;
+        }
+      else
+        {
+          // the entry is freed when its tick fires
+          entry->event.clear ();
+          entry->prev = entry->next = 0;
+        }
+      entry = next;
     }
+}
 
-  eventsForLabel.clear ();
+void
+Scheduler::unlink (Entry *entry)
+{
+  if (entry->next != 0)
+    entry->next->prev = entry->prev;
+
+  if (entry->prev != 0)
+    entry->prev->next = entry->next;
+  else if (entry->next != 0)
+    m_labeledEvents [entry->label] = entry->next;
+  else
+    m_labeledEvents.erase (entry->label);
+}
+
+void
+Scheduler::fire (Entry *entry)
+{
+  unlink (entry);
+  Event event;
+  event.swap (entry->event);
+  delete entry;
+
+  event ();
 }
 
+void
+Scheduler::fireTick (int64_t tick)
+{
+  // events scheduled by the events of the tick go to a new one
+  vector<Entry*> entries;
+  boost::unordered_map<int64_t, Tick>::iterator it = m_ticks.find (tick);
+  entries.swap (it->second.entries);
+  m_ticks.erase (it);
+
+  for (vector<Entry*>::iterator entry = entries.begin (); entry != entries.end (); ++entry)
+    {
+      if ((*entry)->event.empty ())
+        {
+          delete *entry;
+          continue;
+        }
+      fire (*entry);
+    }
+}
 
 }
 }
@@ -26,8 +26,8 @@
 #include <ns3/nstime.h>
 #include <ns3/event-id.h>
 #include <ns3/simulator.h>
-#include <list>
-#include <map>
+#include <vector>
+#include <boost/unordered_map.hpp>
 
 #include "sync-event.h"
 
@@ -44,20 +44,34 @@ namespace ndn {
  * @ingroup sync
  * @brief General purpose event scheduler
  *
- * This class internally runs a thread and events can be scheduled by specifying an absolute or relative time of the event
+ * Events can be scheduled by specifying a relative time of the event, and are cancelled by
+ * label.  The events of a label are kept in a list that an event leaves when it fires, so
+ * scheduling and firing an event take constant time whatever the number of events pending
+ * for the label.
+ *
+ * With a tick set, the scheduler works as a hashed timing wheel: an event is delayed to the
+ * end of the tick it falls in, and all the events of a tick are fired by one simulator event
+ * in the order they were scheduled.
  */
 class Scheduler
 {
 public:
   /**
-   * @brief Default constructor. Thread will be created
+   * @brief Default constructor, events are fired at their exact time
    */
   Scheduler ();
   /**
-   * @brief Destructor. Thread will be nicely stopped
+   * @brief Destructor. Pending events are cancelled
    */
   ~Scheduler ();
 
+  /**
+   * @brief Set the tick events are rounded up to, zero to fire events at their exact time.
+   * Should be set before any event is scheduled
+   */
+  void
+  setTick (const TimeDuration &tick);
+
   /**
    * @brief Schedule an event at absolute time 'abstime'
    * @param abstime Absolute time
@@ -84,11 +98,40 @@ public:
   cancel (uint32_t label);
 
 private:
-  static void
-  eventWrapper (Event event);
+  /**
+   * @brief A pending event, linked in the list of its label
+   */
+  struct Entry
+  {
+    Event event;            // empty once cancelled
+    uint32_t label;
+    Entry *prev;
+    Entry *next;
+    ns3::EventId eventId;   // the simulator event of the entry, unless events are ticked
+  };
+
+  /**
+   * @brief The events that fire at the end of a tick
+   */
+  struct Tick
+  {
+    ns3::EventId eventId;
+    std::vector<Entry*> entries;
+  };
+
+  void
+  unlink (Entry *entry);
+
+  void
+  fire (Entry *entry);
+
+  void
+  fireTick (int64_t tick);
 
 private:
-  std::map< uint32_t, std::list< ns3::EventId > > m_labeledEvents;
+  int64_t m_tick;                                         // nanoseconds, 0 if events are not ticked
+  boost::unordered_map<uint32_t, Entry*> m_labeledEvents;  // first event of each label
+  boost::unordered_map<int64_t, Tick> m_ticks;
 };
   
 }
@@ -23,29 +23,59 @@
 namespace ns3 {
 namespace ndn {
 
-DigestPtr
+SyncTree::DigestMode
+SyncTree::strToDigestMode(const std::string& mode)
+{
+  if (mode == "full") {
+    return FULL_DIGEST;
+  }
+  else if (mode == "incremental") {
+    return INCREMENTAL_DIGEST;
+  }
+  else if (mode == "deferred") {
+    return DEFERRED_DIGEST;
+  }
+  else {
+    throw Error("Digest mode is wrong. No such mode: " + mode);
+  }
+}
+
+void
+SyncTree::setDigestMode(DigestMode mode)
+{
+  m_mode = mode;
+  m_isDirty = false;
+  m_pending = DigestValue();
+  // an empty tree keeps the initial root so that it matches the digests already logged
+  if (!m_nodes.empty())
+    calculateDigest();
+}
+
+void
 SyncTree::update(const ActionEntry& action)
 {
-  Name creator = action.getCreatorName();
-  std::map<Name, TreeEntry>::iterator it = m_nodes.find(creator);
-  if (it == m_nodes.end()) {
+  CreatorId creator = action.getCreatorId();
+  if (lookup(creator) == m_nodes.end()) {
     TreeEntry entry;
     entry.first = 0;
     entry.last = action.getSeqNo();
     entry.digest = action.getDigest();
-    m_nodes[creator] = entry;
+    insertNode(action.getCreatorName(), creator, entry);
+    updateRoot(0, entry.digest);
   }
   else {
+    std::map<Name, TreeEntry>::iterator it = m_index[creator];
     if (it->second.last < action.getSeqNo()) {
       //it->second.first = action.getSeqNo();
+      DigestValue oldDigest = it->second.digest;
       it->second.last = action.getSeqNo();
       it->second.digest = action.getDigest();
+      updateRoot(&oldDigest, it->second.digest);
     }
     else {
       // do nothing, this situation can only happen when fetching actions responses are out of order
     }
   }
-  return calculateDigest();
 }
 
 void
@@ -57,30 +87,86 @@ SyncTree::updateForSnapshot()
   }
 }
 
+void
+SyncTree::updateForEviction(CreatorId creator, uint64_t seq)
+{
+  if (lookup(creator) == m_nodes.end())
+    return;
+  TreeEntry& entry = m_index[creator]->second;
+  if (entry.first < seq)
+    entry.first = std::min(seq, entry.last);
+}
+
 void
 SyncTree::addNode(const Name& name)
 {
   TreeEntry entry;
   entry.first = 0;
   entry.last = 0;
-  entry.digest = make_shared<Digest>();
-  *entry.digest << name.toUri() << entry.last;
-  entry.digest->finalize();
-  m_nodes[name] = entry;
+  DigestBuilder builder;
+  builder << name.toUri() << entry.last;
+  entry.digest = builder.finalize();
+
+  // a placeholder does not change the advertised root, it is only folded into the root by
+  // the next update; the incremental root keeps the change pending until then
+  CreatorId creator = CreatorTable::getInstance().intern(name);
+  if (lookup(creator) == m_nodes.end()) {
+    insertNode(name, creator, entry);
+  }
+  else {
+    std::map<Name, TreeEntry>::iterator it = m_index[creator];
+    m_pending -= it->second.digest;
+    it->second = entry;
+  }
+  m_pending += entry.digest;
 }
 
-DigestPtr
+void
+SyncTree::updateRoot(const DigestValue* oldDigest, const DigestValue& newDigest)
+{
+  switch (m_mode) {
+    case INCREMENTAL_DIGEST:
+      m_root += m_pending;
+      m_pending = DigestValue();
+      if (oldDigest != 0)
+        m_root -= *oldDigest;
+      m_root += newDigest;
+      break;
+    case DEFERRED_DIGEST:
+      m_isDirty = true;
+      break;
+    default:
+      calculateDigest();
+      break;
+  }
+}
+
+const DigestValue&
 SyncTree::calculateDigest()
 {
-  std::map<Name, TreeEntry>::iterator it = m_nodes.begin();
-  shared_ptr<Digest> digest = make_shared<Digest>();
+  if (m_mode == INCREMENTAL_DIGEST) {
+    m_root = m_seed;
+    for (std::map<Name, TreeEntry>::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+      m_root += it->second.digest;
+  }
+  else {
+    m_root = calculateFullDigest();
+  }
+  m_pending = DigestValue();
+  m_isDirty = false;
+  return m_root;
+}
+
+DigestValue
+SyncTree::calculateFullDigest() const
+{
+  std::map<Name, TreeEntry>::const_iterator it = m_nodes.begin();
+  DigestBuilder builder;
   while (it != m_nodes.end()) {
-    *digest << *it->second.digest;
+    builder << it->second.digest;
     ++it;
   }
-  digest->finalize();
-  m_root = digest;
-  return m_root;
+  return builder.finalize();
 }
 
 SyncTree::const_iter
@@ -89,5 +175,23 @@ SyncTree::lookup(const Name& creatorName) const
   return m_nodes.find(creatorName);
 }
 
+SyncTree::const_iter
+SyncTree::lookup(CreatorId creator) const
+{
+  if (creator >= m_index.size())
+    return m_nodes.end();
+  return m_index[creator];
+}
+
+std::map<Name, TreeEntry>::iterator
+SyncTree::insertNode(const Name& name, CreatorId creator, const TreeEntry& entry)
+{
+  std::map<Name, TreeEntry>::iterator it = m_nodes.insert(std::make_pair(name, entry)).first;
+  if (creator >= m_index.size())
+    m_index.resize(creator + 1, m_nodes.end());
+  m_index[creator] = it;
+  return it;
+}
+
 }
 }
@@ -23,7 +23,6 @@
 #include "common.hpp"
 #include "sync-digest.hpp"
 #include "action-entry.hpp"
-#include <boost/shared_ptr.hpp>
 namespace ns3 {
 namespace ndn {
 
@@ -31,10 +30,10 @@ struct TreeEntry
 {
   uint64_t first;
   uint64_t last;
-  DigestPtr digest;
+  DigestValue digest;
 };
 
-class SyncTree
+class SyncTree : noncopyable
 {
 public:
   class Error : public std::runtime_error
@@ -47,27 +46,72 @@ public:
     }
   };
 
+  /**
+   * @brief  how the root digest is derived from the creator digests
+   *
+   * FULL_DIGEST         hash of all creator digests, recalculated on every update
+   * INCREMENTAL_DIGEST  seed plus the sum (mod 2^256) of all creator digests, a changed
+   *                     creator digest is folded into the root in constant time
+   * DEFERRED_DIGEST     same value as FULL_DIGEST, but only recalculated by getDigest()
+   *                     after the tree has changed
+   *
+   * All the repos in a group must use the same mode to agree on root digests.
+   */
+  enum DigestMode
+  {
+    FULL_DIGEST,
+    INCREMENTAL_DIGEST,
+    DEFERRED_DIGEST
+  };
+
 public:
 
   typedef std::map<Name, TreeEntry>::const_iterator const_iter;
 
   SyncTree()
+    : m_mode(FULL_DIGEST)
+    , m_isDirty(false)
   {
-    m_root = make_shared<Digest>();
-    *m_root << "/root";
-    m_root->finalize();
+    DigestBuilder builder;
+    builder << "/root";
+    m_seed = builder.finalize();
+    m_root = m_seed;
+  }
+
+  /**
+   * @brief  convert the mode name used in attributes ("full", "incremental", "deferred")
+   */
+  static DigestMode
+  strToDigestMode(const std::string& mode);
+
+  /**
+   * @brief  switch the way root digest is maintained, root digest is recalculated if the tree
+   *         is not empty
+   */
+  void
+  setDigestMode(DigestMode mode);
+
+  DigestMode
+  getDigestMode() const
+  {
+    return m_mode;
   }
 
   /**
    * @brief  update the digest tree using the received action
-   * @return root digest
    */
-  DigestPtr
+  void
   update(const ActionEntry& action);
 
   void
   updateForSnapshot();
 
+  /**
+   * @brief  the actions of the creator up to 'seq' are only served through the snapshot
+   */
+  void
+  updateForEviction(CreatorId creator, uint64_t seq);
+
   /**
    * @brief  add a node in digest tree
    */
@@ -78,7 +122,7 @@ public:
    * @brief  calculate the current root digest, which represents the status
    * @return root digest
    */
-  DigestPtr
+  const DigestValue&
   calculateDigest();
 
   /**
@@ -88,10 +132,17 @@ public:
   const_iter
   lookup(const Name& creatorName) const;
 
-  DigestPtr
+  const_iter
+  lookup(CreatorId creator) const;
+
+  const DigestValue&
   getDigest() const
   {
-    //std::cout<<"my digest is = "<<*m_root<<std::endl;
+    //std::cout<<"my digest is = "<<m_root<<std::endl;
+    if (m_isDirty) {
+      m_root = calculateFullDigest();
+      m_isDirty = false;
+    }
     return m_root;
   }
 
@@ -108,8 +159,33 @@ public:
   }
 
 private:
+  /**
+   * @brief  reflect the change of one creator digest in the root digest
+   * @param  oldDigest  previous digest of the creator, 0 if the creator is new
+   */
+  void
+  updateRoot(const DigestValue* oldDigest, const DigestValue& newDigest);
+
+  DigestValue
+  calculateFullDigest() const;
+
+  /**
+   * @brief  insert a node for the creator and record it in the id index
+   */
+  std::map<Name, TreeEntry>::iterator
+  insertNode(const Name& name, CreatorId creator, const TreeEntry& entry);
+
+private:
+  // ordered by name, the full root digest is calculated in this order
   std::map<Name, TreeEntry> m_nodes;
-  DigestPtr m_root;
+  // creator id -> node, m_nodes.end() if the creator has no node
+  std::vector<std::map<Name, TreeEntry>::iterator> m_index;
+  DigestMode m_mode;
+  DigestValue m_seed;
+  mutable DigestValue m_root;
+  mutable bool m_isDirty;
+  // placeholder digests not folded into the incremental root yet
+  DigestValue m_pending;
 };
 
 }
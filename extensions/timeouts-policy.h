@@ -147,9 +147,12 @@ struct timeouts_policy_traits
       inline void
       ProcessTimeoutEntry (typename parent_trie::iterator item)
       {
-        item->payload ()->ProcessOnTimeout (item->payload ()->GetInterest ());
-
+        // the entry is erased before the callback runs, so that an Interest expressed again
+        // from it gets an entry of its own, with its own lifetime
+        typename parent_trie::payload_traits::storage_type payload = item->payload ();
         m_base.erase (item);
+
+        payload->ProcessOnTimeout (payload->GetInterest ());
       }
 
     private:
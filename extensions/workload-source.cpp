@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "workload-source.hpp"
+
+#include <boost/make_shared.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+boost::shared_ptr<WorkloadSource>
+WorkloadSource::create(const std::string& type, const Name& prefix, uint32_t count,
+                       const Time& interval, const std::string& trace, const std::string& action)
+{
+  if (type == "burst") {
+    return boost::make_shared<BurstWorkload>(prefix, count, interval, action);
+  }
+  else if (type == "poisson") {
+    return boost::make_shared<PoissonWorkload>(prefix, count, interval, action);
+  }
+  else if (type == "trace") {
+    return boost::make_shared<TraceWorkload>(prefix, trace, action);
+  }
+  else {
+    throw Error("Workload is wrong. No such workload: " + type);
+  }
+}
+
+WorkloadSource::~WorkloadSource()
+{
+}
+
+BurstWorkload::BurstWorkload(const Name& prefix, uint32_t count, const Time& interval,
+                             const std::string& action)
+  : m_prefix(prefix)
+  , m_count(count)
+  , m_interval(interval)
+  , m_index(0)
+{
+  m_action = action;
+}
+
+bool
+BurstWorkload::next()
+{
+  if (m_index == m_count)
+    return false;
+
+  if (m_index > 0)
+    m_time += m_interval;
+  m_dataName = m_prefix;
+  m_dataName.appendSeqNum(m_index);
+  m_index++;
+  return true;
+}
+
+PoissonWorkload::PoissonWorkload(const Name& prefix, uint32_t count, const Time& meanInterval,
+                                 const std::string& action)
+  : m_prefix(prefix)
+  , m_count(count)
+  , m_interval(meanInterval.GetMilliSeconds())
+  , m_index(0)
+{
+  m_action = action;
+}
+
+bool
+PoissonWorkload::next()
+{
+  if (m_index == m_count)
+    return false;
+
+  m_time += MicroSeconds(static_cast<uint64_t>(m_interval.GetValue() * 1000));
+  m_dataName = m_prefix;
+  m_dataName.appendSeqNum(m_index);
+  m_index++;
+  return true;
+}
+
+TraceWorkload::TraceWorkload(const Name& prefix, const std::string& trace, const std::string& action)
+  : m_prefix(prefix)
+  , m_trace(trace.c_str())
+  , m_lines(0)
+  , m_line(0)
+  , m_hasNextRun(false)
+{
+  if (!(m_trace >> m_lines))
+    throw Error("Cannot read the workload trace " + trace);
+  m_action = action;
+  m_hasNextRun = readLine();
+}
+
+bool
+TraceWorkload::readLine()
+{
+  if (m_line == m_lines)
+    return false;
+
+  uint64_t start;
+  if (!(m_trace >> start >> m_nextRun.count >> m_nextRun.interval))
+    throw Error("The workload trace is truncated");
+  m_nextRun.time = start * 1000;
+  m_nextRun.line = m_line++;
+  m_nextRun.index = 0;
+  return true;
+}
+
+bool
+TraceWorkload::next()
+{
+  // take the lines that start before the earliest action of the lines already started
+  while (m_hasNextRun && (m_runs.empty() || !(m_nextRun < m_runs.top()))) {
+    if (m_nextRun.count > 0)
+      m_runs.push(m_nextRun);
+    m_hasNextRun = readLine();
+  }
+  if (m_runs.empty())
+    return false;
+
+  Run run = m_runs.top();
+  m_runs.pop();
+  m_time = MilliSeconds(run.time);
+  m_dataName = m_prefix;
+  m_dataName.appendSeqNum(run.line).appendSeqNum(run.index);
+
+  run.index++;
+  run.time += run.interval;
+  if (run.index < run.count)
+    m_runs.push(run);
+  return true;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2014, Regents of the University of California.
+*
+* This file is part of NDN repo-ng (Next generation of NDN repository).
+* See AUTHORS.md for complete list of repo-ng authors and contributors.
+*
+* repo-ng is free software: you can redistribute it and/or modify it under the terms
+* of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* repo-ng is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+* PURPOSE. See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* repo-ng, e.g., in COPYING.md file. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REPO_SYNC_WORKLOAD_SOURCE_HPP
+#define REPO_SYNC_WORKLOAD_SOURCE_HPP
+
+#include "common.hpp"
+
+#include <ns3/nstime.h>
+#include <ns3/random-variable.h>
+
+#include <fstream>
+#include <queue>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Actions generated by a repo, read one at a time
+ *
+ * A source only holds the next action.  The repo schedules an event for it, and reads the
+ * action after it when the event fires, so the workload never sits in the simulator queue.
+ */
+class WorkloadSource : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @brief  create the source of a workload
+   * @param  type      'burst', 'poisson' or 'trace'
+   * @param  prefix    prefix of the data names
+   * @param  count     number of actions of a burst or poisson workload
+   * @param  interval  time between the actions of a burst, mean time between the actions of
+   *                   a poisson workload
+   * @param  trace     trace file of a trace workload
+   * @param  action    action of the workload
+   */
+  static boost::shared_ptr<WorkloadSource>
+  create(const std::string& type, const Name& prefix, uint32_t count, const Time& interval,
+         const std::string& trace, const std::string& action = "insertion");
+
+  virtual
+  ~WorkloadSource();
+
+  /**
+   * @brief  read the next action
+   * @return false once the workload is exhausted
+   */
+  virtual bool
+  next() = 0;
+
+  /**
+   * @brief  time of the action from the start of the workload
+   */
+  const Time&
+  getTime() const
+  {
+    return m_time;
+  }
+
+  const Name&
+  getDataName() const
+  {
+    return m_dataName;
+  }
+
+  const std::string&
+  getAction() const
+  {
+    return m_action;
+  }
+
+protected:
+  Time m_time;
+  Name m_dataName;
+  std::string m_action;
+};
+
+/**
+ * @brief 'count' actions on data prefix/0 to prefix/count-1, 'interval' apart
+ */
+class BurstWorkload : public WorkloadSource
+{
+public:
+  BurstWorkload(const Name& prefix, uint32_t count, const Time& interval,
+                const std::string& action);
+
+  virtual bool
+  next();
+
+private:
+  Name m_prefix;
+  uint32_t m_count;
+  Time m_interval;
+  uint32_t m_index;
+};
+
+/**
+ * @brief 'count' actions on data prefix/0 to prefix/count-1, with exponentially distributed
+ *        times between them
+ */
+class PoissonWorkload : public WorkloadSource
+{
+public:
+  PoissonWorkload(const Name& prefix, uint32_t count, const Time& meanInterval,
+                  const std::string& action);
+
+  virtual bool
+  next();
+
+private:
+  Name m_prefix;
+  uint32_t m_count;
+  ExponentialVariable m_interval;   // milliseconds
+  uint32_t m_index;
+};
+
+/**
+ * @brief Actions read from a trace file
+ *
+ * The file starts with the number of lines that follow.  A line '<start> <count> <interval>'
+ * acts on 'count' data prefix/<line>/0 to prefix/<line>/count-1, the first one 'start' seconds
+ * after the start of the workload and the others 'interval' milliseconds apart.  The lines
+ * are sorted by start time; lines that overlap in time are interleaved.  The file is read a
+ * line at a time, when the actions reach the start of the line.
+ */
+class TraceWorkload : public WorkloadSource
+{
+public:
+  TraceWorkload(const Name& prefix, const std::string& trace, const std::string& action);
+
+  virtual bool
+  next();
+
+private:
+  struct Run
+  {
+    uint64_t time;      // milliseconds
+    uint64_t line;
+    uint64_t index;
+    uint64_t count;
+    uint64_t interval;  // milliseconds
+
+    bool
+    operator<(const Run& other) const
+    {
+      // the earliest run on top of the priority queue, the first line first
+      return time > other.time || (time == other.time && line > other.line);
+    }
+  };
+
+  /**
+   * @brief  read the next line of the trace into m_nextRun
+   */
+  bool
+  readLine();
+
+private:
+  Name m_prefix;
+  std::ifstream m_trace;
+  uint64_t m_lines;
+  uint64_t m_line;
+  Run m_nextRun;
+  bool m_hasNextRun;
+  std::priority_queue<Run> m_runs;   // the lines whose actions have started
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // REPO_SYNC_WORKLOAD_SOURCE_HPP
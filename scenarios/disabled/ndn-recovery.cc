@@ -86,17 +86,21 @@ main (int argc, char *argv[])
   ndn::AppHelper consumerHelper("ns3::ndn::RepoSyncRecovery");
   consumerHelper.SetPrefix("/ndn/broadcast");
   consumerHelper.SetAttribute("Master", StringValue("2"));
+  consumerHelper.SetAttribute("WorkloadTrace", StringValue("/home/justin/generator_2.txt"));
   consumerHelper.SetAttribute("CreatorName", StringValue("/creator/1"));
   consumerHelper.Install(nodes.Get(1));
   consumerHelper.SetAttribute("Master", StringValue("4"));
+  consumerHelper.SetAttribute("WorkloadTrace", StringValue("/home/justin/generator_4.txt"));
   consumerHelper.SetAttribute("CreatorName", StringValue("/creator/3"));
   consumerHelper.Install(nodes.Get (3));
 
   consumerHelper.SetAttribute("Master", StringValue("1"));
+  consumerHelper.SetAttribute("WorkloadTrace", StringValue("/home/justin/generator_1.txt"));
   consumerHelper.SetAttribute("CreatorName", StringValue("/creator/0"));
   consumerHelper.Install (nodes.Get (0)); 
 
   consumerHelper.SetAttribute("Master", StringValue("3"));
+  consumerHelper.SetAttribute("WorkloadTrace", StringValue("/home/justin/generator_3.txt"));
   consumerHelper.SetAttribute("CreatorName", StringValue("/creator/2"));
   consumerHelper.Install (nodes.Get (2));
 